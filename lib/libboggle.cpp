@@ -0,0 +1,284 @@
+/* LIBBOGGLE
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * Implements the C interface declared in libboggle.h on top of the solver. Every entry point
+ * runs its body through callSafely, so that no C++ exception ever crosses into the caller;
+ * a failure is turned into the documented return value plus a message for boggle_last_error. */
+
+#include "libboggle.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <string>
+#include "boardgraph.h"
+#include "dictionarytrie.h"
+#include "error.h"
+#include "gamerules.h"
+#include "grid.h"
+#include "map.h"
+#include "mappedfile.h"
+#include "strlib.h"
+#include "vector.h"
+#include "wordsolver.h"
+using namespace std;
+
+struct boggle_dictionary {
+    DictionaryTrie trie;
+
+    boggle_dictionary(const Vector<string>& words) : trie(words) {}
+};
+
+/* Message of the last failure on each thread. */
+thread_local string lastError;
+
+/* Size of the first version of boggle_options, the smallest a caller may pass. */
+const size_t OPTIONS_V1_SIZE = offsetof(boggle_options, threads) + sizeof(int32_t);
+
+/*************************************************
+ *             PROTOTYPE FUNCTIONS               *
+ ************************************************/
+template <typename T>
+T callSafely(T failure, const function<T()>& body);
+Vector<string> splitWords(const char* text, size_t length);
+const Vector<GameRules>& ruleSetTable();
+const GameRules& ruleSetAt(int32_t rule_set);
+boggle_options readOptions(const boggle_options* options);
+BoardGraph boardFromLetters(const char* letters, const boggle_options& options);
+Vector<int> solveForRules(const DictionaryTrie& trie, const BoardGraph& graph,
+                          const boggle_options& options);
+
+
+/*************************************************
+ *                  FUNCTIONS                    *
+ ************************************************/
+
+int32_t boggle_abi_version(void) {
+    return BOGGLE_ABI_VERSION;
+}
+
+const char* boggle_last_error(void) {
+    return lastError.c_str();
+}
+
+boggle_dictionary* boggle_dictionary_load(const char* path) {
+    return callSafely<boggle_dictionary*>(nullptr, [&]() {
+        if(path == nullptr) {
+            error("boggle_dictionary_load: no path given");
+        }
+        MappedFile file(path);
+        return new boggle_dictionary(splitWords(file.data(), file.size()));
+    });
+}
+
+boggle_dictionary* boggle_dictionary_attach(const char* text, size_t length) {
+    return callSafely<boggle_dictionary*>(nullptr, [&]() {
+        if(text == nullptr && length > 0) {
+            error("boggle_dictionary_attach: no text given");
+        }
+        return new boggle_dictionary(splitWords(text, length));
+    });
+}
+
+void boggle_dictionary_free(boggle_dictionary* dictionary) {
+    delete dictionary;
+}
+
+int32_t boggle_dictionary_size(const boggle_dictionary* dictionary) {
+    return dictionary == nullptr ? 0 : dictionary->trie.wordCount();
+}
+
+uint32_t boggle_dictionary_fingerprint(const boggle_dictionary* dictionary) {
+    return dictionary == nullptr ? 0 : dictionary->trie.fingerprint();
+}
+
+const char* boggle_word(const boggle_dictionary* dictionary, int32_t id, size_t* length) {
+    if(dictionary == nullptr || id < 0 || id >= dictionary->trie.wordCount()) {
+        return nullptr;
+    }
+    const string& word = dictionary->trie.word(id);
+    if(length != nullptr) {
+        *length = word.length();
+    }
+    return word.c_str();
+}
+
+int32_t boggle_word_id(const boggle_dictionary* dictionary, const char* word) {
+    if(dictionary == nullptr || word == nullptr) {
+        return -1;
+    }
+    const DictionaryTrie& trie = dictionary->trie;
+    int node = trie.find(toUpperCase(word));
+    return node == DictionaryTrie::NONE ? -1 : trie.wordId(node);
+}
+
+void boggle_default_options(boggle_options* options) {
+    if(options != nullptr) {
+        *options = boggle_options {(uint32_t) sizeof(boggle_options), 4, 4, BOGGLE_GRID,
+                                   BOGGLE_USE_EACH_CUBE_ONCE, 0, 1};
+    }
+}
+
+int32_t boggle_rule_set_count(void) {
+    return ruleSetTable().size();
+}
+
+const char* boggle_rule_set_name(int32_t rule_set) {
+    if(rule_set < 0 || rule_set >= ruleSetTable().size()) {
+        return nullptr;
+    }
+    return ruleSetTable()[rule_set].name.c_str();
+}
+
+/* The ids are copied straight from the solver's result into the caller's buffer. */
+int32_t boggle_solve(const boggle_dictionary* dictionary, const char* letters,
+                     const boggle_options* options, int32_t* word_ids, int32_t capacity) {
+    return callSafely<int32_t>(-1, [&]() {
+        boggle_options checked = readOptions(options);
+        if(dictionary == nullptr || (word_ids == nullptr && capacity > 0)) {
+            error("boggle_solve: no dictionary or buffer given");
+        }
+        Vector<int> ids = solveForRules(dictionary->trie, boardFromLetters(letters, checked), checked);
+        copy(ids.begin(), ids.begin() + min(max(capacity, 0), ids.size()), word_ids);
+        return (int32_t) ids.size();
+    });
+}
+
+int32_t boggle_validate(const boggle_dictionary* dictionary, const char* letters,
+                        const boggle_options* options, const char* word) {
+    return callSafely<int32_t>(-1, [&]() {
+        boggle_options checked = readOptions(options);
+        if(dictionary == nullptr || word == nullptr) {
+            error("boggle_validate: no dictionary or word given");
+        }
+        BoardGraph graph = boardFromLetters(letters, checked);
+        string upper = toUpperCase(word);
+        return (int32_t) (dictionary->trie.contains(upper) && ruleSetAt(checked.rule_set).allows(upper) &&
+                          !findWordPath(graph, upper, (DiceRule) checked.dice_rule).isEmpty());
+    });
+}
+
+int32_t boggle_score(const char* word, int32_t rule_set) {
+    return callSafely<int32_t>(-1, [&]() {
+        const GameRules& rules = ruleSetAt(rule_set);
+        string upper = toUpperCase(word == nullptr ? "" : word);
+        return (int32_t) (rules.allows(upper) ? rules.score(upper) : 0);
+    });
+}
+
+int64_t boggle_score_words(const boggle_dictionary* dictionary, const int32_t* word_ids,
+                           int32_t count, int32_t rule_set) {
+    return callSafely<int64_t>(-1, [&]() {
+        const GameRules& rules = ruleSetAt(rule_set);
+        if(dictionary == nullptr || (word_ids == nullptr && count > 0)) {
+            error("boggle_score_words: no dictionary or ids given");
+        }
+        int64_t total = 0;
+        for(int32_t i = 0; i < count; i++) {
+            if(word_ids[i] < 0 || word_ids[i] >= dictionary->trie.wordCount()) {
+                error("boggle_score_words: no word has id " + integerToString(word_ids[i]));
+            }
+            const string& word = dictionary->trie.word(word_ids[i]);
+            total += rules.allows(word) ? rules.score(word) : 0;
+        }
+        return total;
+    });
+}
+
+/* Runs body, returning failure instead if it throws, with the reason kept for
+ * boggle_last_error. */
+template <typename T>
+T callSafely(T failure, const function<T()>& body) {
+    try {
+        return body();
+    } catch(ErrorException& ex) {
+        lastError = ex.getMessage();
+    } catch(exception& ex) {
+        lastError = ex.what();
+    } catch(...) {
+        lastError = "unknown error";
+    }
+    return failure;
+}
+
+/* Splits text into lines, dropping the carriage returns of Windows line endings. */
+Vector<string> splitWords(const char* text, size_t length) {
+    Vector<string> words;
+    size_t start = 0;
+    for(size_t i = 0; i <= length; i++) {
+        if(i == length || text[i] == '\n' || text[i] == '\r') {
+            if(i > start) {
+                words.add(string(text + start, i - start));
+            }
+            start = i + 1;
+        }
+    }
+    return words;
+}
+
+/* The rule sets are built once, on first use, and shared by every thread after that. */
+const Vector<GameRules>& ruleSetTable() {
+    static const Vector<GameRules> rules = ruleSets();
+    return rules;
+}
+
+/* Returns the rule set with the given index, or throws an ErrorException. */
+const GameRules& ruleSetAt(int32_t rule_set) {
+    if(rule_set < 0 || rule_set >= ruleSetTable().size()) {
+        error("there is no rule set " + integerToString(rule_set));
+    }
+    return ruleSetTable()[rule_set];
+}
+
+/* Returns a copy of the caller's options, holding the defaults for any fields added after the
+ * version the caller was built against; fields of a newer version than this library are not
+ * read. Throws an ErrorException if the options are missing, smaller than the first version,
+ * or hold invalid values. */
+boggle_options readOptions(const boggle_options* options) {
+    if(options == nullptr || options->size < OPTIONS_V1_SIZE) {
+        error("the options are missing or not set up by boggle_default_options");
+    }
+    boggle_options checked;
+    boggle_default_options(&checked);
+    memcpy(&checked, options, min((size_t) options->size, sizeof(boggle_options)));
+    checked.size = sizeof(boggle_options);
+    if(checked.rows <= 0 || checked.cols <= 0 || checked.shape < BOGGLE_GRID ||
+       checked.shape > BOGGLE_HEXAGON || checked.dice_rule < BOGGLE_USE_EACH_CUBE_ONCE ||
+       checked.dice_rule > BOGGLE_LETTER_BAG || checked.threads < 1) {
+        error("the options are invalid");
+    }
+    ruleSetAt(checked.rule_set);
+    return checked;
+}
+
+/* Builds the graph of the board given by its letters, which must fill the rows and columns
+ * of the options exactly. */
+BoardGraph boardFromLetters(const char* letters, const boggle_options& options) {
+    string board = toUpperCase(letters == nullptr ? "" : letters);
+    if((int) board.length() != options.rows * options.cols) {
+        error("the board has " + integerToString(board.length()) + " letters instead of " +
+              integerToString(options.rows * options.cols));
+    }
+    Grid<char> grid(options.rows, options.cols);
+    for(int i = 0; i < (int) board.length(); i++) {
+        grid[i / options.cols][i % options.cols] = board[i];
+    }
+    if(options.shape == BOGGLE_TORUS) {
+        return torusBoardGraph(grid);
+    } else if(options.shape == BOGGLE_HEXAGON) {
+        return hexBoardGraph(grid);
+    }
+    return gridBoardGraph(grid);
+}
+
+/* Solves with the dice rule and threads of the options, for the words their rule set allows. */
+Vector<int> solveForRules(const DictionaryTrie& trie, const BoardGraph& graph,
+                          const boggle_options& options) {
+    SolveOptions solveOptions;
+    solveOptions.rule = (DiceRule) options.dice_rule;
+    solveOptions.threads = options.threads;
+    Map<int, string> wildcardSpellings;
+    return solveWithRules(graph, trie, ruleSetAt(options.rule_set), solveOptions, wildcardSpellings);
+}
@@ -0,0 +1,128 @@
+/* LIBBOGGLE
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * A C interface to the word solver, for programs that embed it in-process instead of running
+ * the game. The library is built from lib/libboggle.cpp together with the non-GUI sources in
+ * src/ (everything but boggle.cpp, gui.cpp, and boggleguiwindow.cpp), and depends on nothing
+ * from the console or the GUI.
+ *
+ * The interface only uses C types and opaque handles, so it can be called through any foreign
+ * function interface. Structs passed in start with their own size, which lets later versions
+ * add fields without breaking callers built against this one.
+ *
+ * Words are identified by id, their position in the dictionary's sorted word list. Solving a
+ * board writes ids into a buffer the caller owns, and the text of a word is read in place from
+ * the dictionary, so no strings are allocated or copied to report a result.
+ *
+ * Every function may be called from any thread, and a dictionary may be shared by any number
+ * of threads once it is loaded. A function that fails returns NULL or -1 and leaves a message
+ * for boggle_last_error on the calling thread. */
+
+#ifndef _libboggle_h
+#define _libboggle_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(_WIN32)
+#define BOGGLE_API __declspec(dllexport)
+#else
+#define BOGGLE_API __attribute__((visibility("default")))
+#endif
+
+/* Version of this interface; it changes only when existing functions or structs change. */
+#define BOGGLE_ABI_VERSION 1
+
+/* Board shapes. */
+#define BOGGLE_GRID 0       /* rows x cols with the classic 8-neighborhood */
+#define BOGGLE_TORUS 1      /* the grid, wrapping around its edges */
+#define BOGGLE_HEXAGON 2    /* offset rows of hexagonal cells */
+
+/* Dice rules; see DiceRule in wordsolver.h. */
+#define BOGGLE_USE_EACH_CUBE_ONCE 0
+#define BOGGLE_NO_IMMEDIATE_REUSE 1
+#define BOGGLE_LETTER_BAG 2
+
+typedef struct boggle_dictionary boggle_dictionary;
+
+typedef struct boggle_options {
+    uint32_t size;        /* sizeof(boggle_options), set by boggle_default_options */
+    int32_t rows;
+    int32_t cols;
+    int32_t shape;        /* BOGGLE_GRID, BOGGLE_TORUS, or BOGGLE_HEXAGON */
+    int32_t dice_rule;    /* one of the dice rules above */
+    int32_t rule_set;     /* index of the scoring rules, see boggle_rule_set_name */
+    int32_t threads;      /* threads to search one board with */
+} boggle_options;
+
+/* Returns BOGGLE_ABI_VERSION as the library was built. */
+BOGGLE_API int32_t boggle_abi_version(void);
+
+/* Returns a description of the last failure on the calling thread, or "" if there was none.
+ * The text stays valid until the next failing call on the same thread. */
+BOGGLE_API const char* boggle_last_error(void);
+
+/* Loads a dictionary from a file of words, one per line. Words are uppercased, and words with
+ * characters other than A-Z are skipped. Returns NULL if the file cannot be read. */
+BOGGLE_API boggle_dictionary* boggle_dictionary_load(const char* path);
+
+/* Builds a dictionary from length bytes of text in memory, holding words as a file would. The
+ * text is not referenced after the call returns. */
+BOGGLE_API boggle_dictionary* boggle_dictionary_attach(const char* text, size_t length);
+
+BOGGLE_API void boggle_dictionary_free(boggle_dictionary* dictionary);
+
+/* Returns the number of words, whose ids are 0 to that number - 1. */
+BOGGLE_API int32_t boggle_dictionary_size(const boggle_dictionary* dictionary);
+
+/* Returns a checksum of the word list, which changes whenever the word ids do. */
+BOGGLE_API uint32_t boggle_dictionary_fingerprint(const boggle_dictionary* dictionary);
+
+/* Returns the uppercase, NUL-terminated text of the word with the given id, and stores its
+ * length in *length unless length is NULL. The text belongs to the dictionary and stays valid
+ * until it is freed. Returns NULL for an id out of range. */
+BOGGLE_API const char* boggle_word(const boggle_dictionary* dictionary, int32_t id, size_t* length);
+
+/* Returns the id of the word, in any case, or -1 if it is not in the dictionary. */
+BOGGLE_API int32_t boggle_word_id(const boggle_dictionary* dictionary, const char* word);
+
+/* Fills in the options for a 4x4 grid under the classic dice rule and standard scoring. */
+BOGGLE_API void boggle_default_options(boggle_options* options);
+
+/* Returns the number of predefined scoring rule sets, and the name of the one with the given
+ * index (NULL if out of range). Index 0 is the standard rules. */
+BOGGLE_API int32_t boggle_rule_set_count(void);
+BOGGLE_API const char* boggle_rule_set_name(int32_t rule_set);
+
+/* Solves the board, whose rows * cols letters are given in row-major order ('?' for a blank
+ * cube, '.' for a hole), and writes the ids of the words found, in increasing order, to
+ * word_ids. Only words the rule set allows are reported. Returns the number of words found,
+ * of which at most capacity are written; a caller seeing a larger number can retry with a
+ * bigger buffer. Returns -1 if the board or options are invalid. */
+BOGGLE_API int32_t boggle_solve(const boggle_dictionary* dictionary, const char* letters,
+                                const boggle_options* options, int32_t* word_ids, int32_t capacity);
+
+/* Returns 1 if the word is in the dictionary, allowed by the rule set, and can be formed on
+ * the board under the dice rule, 0 if not, and -1 if the board or options are invalid. */
+BOGGLE_API int32_t boggle_validate(const boggle_dictionary* dictionary, const char* letters,
+                                   const boggle_options* options, const char* word);
+
+/* Returns the points the word scores under the rule set, or -1 for an unknown rule set.
+ * Words the rule set does not allow score 0. */
+BOGGLE_API int32_t boggle_score(const char* word, int32_t rule_set);
+
+/* Returns the total points of count words given by id, such as the output of boggle_solve,
+ * or -1 for an unknown rule set or an id out of range. */
+BOGGLE_API int64_t boggle_score_words(const boggle_dictionary* dictionary, const int32_t* word_ids,
+                                      int32_t count, int32_t rule_set);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _libboggle_h
@@ -0,0 +1,241 @@
+/* BOARD GRAPH
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * Builds the CSR adjacency used by the word search algorithms. The adjacency of the common
+ * board shapes only depends on their dimensions, so it is computed once per shape and size
+ * and reused for every board after that; only boards with holes pay for a rebuild. The cache
+ * is locked, so graphs can be built from any number of threads. */
+
+#include "boardgraph.h"
+#include <mutex>
+#include <string>
+#include "error.h"
+#include "map.h"
+#include "strlib.h"
+using namespace std;
+
+/*************************************************
+ *             PROTOTYPE FUNCTIONS               *
+ ************************************************/
+BoardGraph cachedTopology(BoardGraph::Shape shape, int rows, int cols);
+BoardGraph buildTopology(BoardGraph::Shape shape, int rows, int cols);
+void addGridNeighbors(BoardGraph& graph, int row, int col);
+void addTorusNeighbors(BoardGraph& graph, int row, int col);
+void addHexNeighbors(BoardGraph& graph, int row, int col);
+void addCubeNeighbors(BoardGraph& graph, int size, int layer, int row, int col);
+void addIfInBounds(BoardGraph& graph, int row, int col);
+BoardGraph withLetters(BoardGraph graph, const Grid<char>& board);
+void removeHoles(BoardGraph& graph);
+void buildNeighborMasks(BoardGraph& graph);
+
+
+/*************************************************
+ *                  FUNCTIONS                    *
+ ************************************************/
+
+BoardGraph gridBoardGraph(const Grid<char>& board) {
+    BoardGraph::Shape shape = board.numRows() == board.numCols() ? BoardGraph::SQUARE
+                                                                  : BoardGraph::RECTANGLE;
+    return withLetters(cachedTopology(shape, board.numRows(), board.numCols()), board);
+}
+
+BoardGraph torusBoardGraph(const Grid<char>& board) {
+    return withLetters(cachedTopology(BoardGraph::TORUS, board.numRows(), board.numCols()), board);
+}
+
+BoardGraph hexBoardGraph(const Grid<char>& board) {
+    return withLetters(cachedTopology(BoardGraph::HEXAGON, board.numRows(), board.numCols()), board);
+}
+
+BoardGraph cubeBoardGraph(const Vector<char>& letters, int size) {
+    if(letters.size() != size * size * size) {
+        error("cubeBoardGraph: expected " + integerToString(size * size * size) +
+              " letters but got " + integerToString(letters.size()));
+    }
+    BoardGraph graph = cachedTopology(BoardGraph::CUBE, size * size, size);
+    graph.letters = letters;
+    removeHoles(graph);
+    return graph;
+}
+
+BoardGraph customBoardGraph(const Vector<char>& letters, const Vector<Vector<int>>& adjacency,
+                            int rows, int cols) {
+    if(letters.size() != adjacency.size() || letters.size() != rows * cols) {
+        error("customBoardGraph: expected " + integerToString(rows * cols) +
+              " cells but got " + integerToString(letters.size()) + " letters and " +
+              integerToString(adjacency.size()) + " adjacency lists");
+    }
+    BoardGraph graph;
+    graph.shape = BoardGraph::CUSTOM;
+    graph.rows = rows;
+    graph.cols = cols;
+    graph.letters = letters;
+    graph.offsets.add(0);
+    Vector<int> listedBy(letters.size(), -1);    // last cell whose list named each cell
+    for(int cell = 0; cell < adjacency.size(); cell++) {
+        for(int next : adjacency[cell]) {
+            if(next < 0 || next >= letters.size() || next == cell || listedBy[next] == cell) {
+                error("customBoardGraph: cell " + integerToString(cell) +
+                      " has an invalid or repeated neighbor " + integerToString(next));
+            }
+            listedBy[next] = cell;
+            graph.neighbors.add(next);
+        }
+        graph.offsets.add(graph.neighbors.size());
+    }
+    removeHoles(graph);
+    buildNeighborMasks(graph);
+    return graph;
+}
+
+/* The adjacency for a shape and size is built the first time it is requested and copied
+ * out of the cache on every later request. */
+BoardGraph cachedTopology(BoardGraph::Shape shape, int rows, int cols) {
+    static Map<string, BoardGraph> cache;
+    static mutex cacheLock;
+    lock_guard<mutex> lock(cacheLock);
+    string key = integerToString(shape) + ":" + integerToString(rows) + "x" + integerToString(cols);
+    if(!cache.containsKey(key)) {
+        cache.put(key, buildTopology(shape, rows, cols));
+    }
+    return cache[key];
+}
+
+/* Every cell of a rows x cols layout is connected to its in-bounds neighbors for the shape. */
+BoardGraph buildTopology(BoardGraph::Shape shape, int rows, int cols) {
+    BoardGraph graph;
+    graph.shape = shape;
+    graph.rows = rows;
+    graph.cols = cols;
+    graph.letters = Vector<char>(rows * cols, BOARD_HOLE);
+    graph.offsets.add(0);
+    for(int row = 0; row < rows; row++) {
+        for(int col = 0; col < cols; col++) {
+            if(shape == BoardGraph::HEXAGON) {
+                addHexNeighbors(graph, row, col);
+            } else if(shape == BoardGraph::TORUS) {
+                addTorusNeighbors(graph, row, col);
+            } else if(shape == BoardGraph::CUBE) {
+                addCubeNeighbors(graph, cols, row / cols, row % cols, col);
+            } else {
+                addGridNeighbors(graph, row, col);
+            }
+            graph.offsets.add(graph.neighbors.size());
+        }
+    }
+    buildNeighborMasks(graph);
+    return graph;
+}
+
+/* Adds the up to 8 cells surrounding (row, col), in the same order the original
+ * inBounds scan visited them. */
+void addGridNeighbors(BoardGraph& graph, int row, int col) {
+    for(int i = -1; i <= 1; i++) {
+        for(int j = -1; j <= 1; j++) {
+            if(i != 0 || j != 0) {
+                addIfInBounds(graph, row + i, col + j);
+            }
+        }
+    }
+}
+
+/* Adds the 8 cells surrounding (row, col), wrapping around the edges of the board. On boards
+ * narrower than 3 cells the wrapped neighbors repeat, so each one is only added once. */
+void addTorusNeighbors(BoardGraph& graph, int row, int col) {
+    int first = graph.neighbors.size();
+    for(int i = -1; i <= 1; i++) {
+        for(int j = -1; j <= 1; j++) {
+            int next = ((row + i + graph.rows) % graph.rows) * graph.cols +
+                       (col + j + graph.cols) % graph.cols;
+            bool repeated = next == row * graph.cols + col;
+            for(int k = first; k < graph.neighbors.size(); k++) {
+                repeated = repeated || graph.neighbors[k] == next;
+            }
+            if(!repeated) {
+                graph.neighbors.add(next);
+            }
+        }
+    }
+}
+
+/* Adds the up to 6 cells touching (row, col) when odd rows are shifted half a cell right. */
+void addHexNeighbors(BoardGraph& graph, int row, int col) {
+    int shift = row % 2 == 0 ? -1 : 0;
+    addIfInBounds(graph, row - 1, col + shift);
+    addIfInBounds(graph, row - 1, col + shift + 1);
+    addIfInBounds(graph, row, col - 1);
+    addIfInBounds(graph, row, col + 1);
+    addIfInBounds(graph, row + 1, col + shift);
+    addIfInBounds(graph, row + 1, col + shift + 1);
+}
+
+/* Adds the up to 26 cells surrounding (layer, row, col) in a size x size x size cube. */
+void addCubeNeighbors(BoardGraph& graph, int size, int layer, int row, int col) {
+    for(int i = -1; i <= 1; i++) {
+        for(int j = -1; j <= 1; j++) {
+            for(int k = -1; k <= 1; k++) {
+                if((i != 0 || j != 0 || k != 0) && layer + i >= 0 && layer + i < size &&
+                        row + j >= 0 && row + j < size && col + k >= 0 && col + k < size) {
+                    graph.neighbors.add(((layer + i) * size + row + j) * size + col + k);
+                }
+            }
+        }
+    }
+}
+
+/* Appends (row, col) to the adjacency list being built if it lies on the board. */
+void addIfInBounds(BoardGraph& graph, int row, int col) {
+    if(row >= 0 && row < graph.rows && col >= 0 && col < graph.cols) {
+        graph.neighbors.add(row * graph.cols + col);
+    }
+}
+
+/* Copies the board's letters onto a cached topology. */
+BoardGraph withLetters(BoardGraph graph, const Grid<char>& board) {
+    for(int row = 0; row < graph.rows; row++) {
+        for(int col = 0; col < graph.cols; col++) {
+            graph.letters[row * graph.cols + col] = board[row][col];
+        }
+    }
+    removeHoles(graph);
+    return graph;
+}
+
+/* Drops every edge touching a hole so that the search never has to check for them. */
+void removeHoles(BoardGraph& graph) {
+    if(!graph.letters.contains(BOARD_HOLE)) {
+        return;
+    }
+    Vector<int> offsets;
+    Vector<int> neighbors;
+    offsets.add(0);
+    for(int cell = 0; cell < graph.cellCount(); cell++) {
+        if(graph.letters[cell] != BOARD_HOLE) {
+            for(int i = graph.offsets[cell]; i < graph.offsets[cell + 1]; i++) {
+                if(graph.letters[graph.neighbors[i]] != BOARD_HOLE) {
+                    neighbors.add(graph.neighbors[i]);
+                }
+            }
+        }
+        offsets.add(neighbors.size());
+    }
+    graph.offsets = offsets;
+    graph.neighbors = neighbors;
+    buildNeighborMasks(graph);
+}
+
+/* Mirrors the adjacency lists as bit masks for boards small enough to use them. */
+void buildNeighborMasks(BoardGraph& graph) {
+    graph.neighborMasks.clear();
+    if(graph.cellCount() > MAX_MASK_CELLS) {
+        return;
+    }
+    for(int cell = 0; cell < graph.cellCount(); cell++) {
+        uint64_t mask = 0;
+        for(int i = graph.offsets[cell]; i < graph.offsets[cell + 1]; i++) {
+            mask |= uint64_t(1) << graph.neighbors[i];
+        }
+        graph.neighborMasks.add(mask);
+    }
+}
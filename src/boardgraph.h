@@ -0,0 +1,99 @@
+/* BOARD GRAPH
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * A Boggle board is represented to the word search algorithms as a graph: every cell holds
+ * one letter and knows which cells are adjacent to it. The adjacency lists are stored in
+ * compressed sparse row (CSR) form, so the neighbors of cell i are
+ * neighbors[offsets[i]] ... neighbors[offsets[i + 1] - 1]. This lets the same search run on
+ * square and rectangular boards, hexagonal boards, boards with holes, or any custom shape.
+ * Cells are numbered in row-major order over a rows x cols layout so that they can still be
+ * highlighted on the GUI. Boards with at most 64 cells also carry each cell's neighbors as a
+ * 64-bit mask, which lets the search track used cells in a single machine word. */
+
+#ifndef _boardgraph_h
+#define _boardgraph_h
+
+#include <cstdint>
+#include "grid.h"
+#include "vector.h"
+
+/* A cell holding this character is a hole: it has no letter and no neighbors. */
+const char BOARD_HOLE = '.';
+
+/* A cell holding this character is a blank cube, which stands for any letter. */
+const char BOARD_WILDCARD = '?';
+
+/* Largest board whose cells fit in one 64-bit neighbor or visited mask. */
+const int MAX_MASK_CELLS = 64;
+
+struct BoardGraph {
+    /* The shape the adjacency was built from. SQUARE and RECTANGLE boards use the classic
+     * 8-neighborhood, TORUS boards wrap that neighborhood around the opposite edges,
+     * HEXAGON boards use 6 neighbors per cell, CUBE boards are 3-D with up to 26 neighbors
+     * per cell, and CUSTOM boards use whatever adjacency the caller supplied. */
+    enum Shape { SQUARE, RECTANGLE, TORUS, HEXAGON, CUBE, CUSTOM };
+
+    Shape shape;
+    int rows;
+    int cols;
+    Vector<char> letters;     // letter on each cell, or BOARD_HOLE
+    Vector<int> offsets;      // cellCount() + 1 entries into neighbors
+    Vector<int> neighbors;    // concatenated adjacency lists
+    Vector<uint64_t> neighborMasks;  // bit j of entry i is set if j is adjacent to i;
+                                     // empty when there are more than MAX_MASK_CELLS cells
+
+    int cellCount() const {
+        return letters.size();
+    }
+
+    int degree(int cell) const {
+        return offsets[cell + 1] - offsets[cell];
+    }
+
+    int row(int cell) const {
+        return cell / cols;
+    }
+
+    int col(int cell) const {
+        return cell % cols;
+    }
+
+    bool hasMasks() const {
+        return !neighborMasks.isEmpty();
+    }
+};
+
+/* Returns true if a cell showing cellLetter can be used to spell letter. */
+inline bool cellMatches(char cellLetter, char letter) {
+    return cellLetter == letter || cellLetter == BOARD_WILDCARD;
+}
+
+/* Returns the index of the lowest set bit of a non-empty cell mask. */
+inline int lowestCell(uint64_t mask) {
+    return __builtin_ctzll(mask);
+}
+
+/* Builds the graph for a rectangular board with the standard 8-neighborhood. */
+BoardGraph gridBoardGraph(const Grid<char>& board);
+
+/* Builds the graph for a wraparound board, where the top edge touches the bottom edge and the
+ * left edge touches the right edge, so that every cell has 8 neighbors. */
+BoardGraph torusBoardGraph(const Grid<char>& board);
+
+/* Builds the graph for a hexagonal board laid out in offset rows, where every odd row is
+ * shifted half a cell to the right and each cell touches at most 6 others. */
+BoardGraph hexBoardGraph(const Grid<char>& board);
+
+/* Builds the graph for a size x size x size cube, where every cell touches the up to 26 cells
+ * around it in three dimensions. letters lists the cells layer by layer, each layer in
+ * row-major order; the layers are stacked vertically in a size * size x size layout. */
+BoardGraph cubeBoardGraph(const Vector<char>& letters, int size);
+
+/* Builds the graph for an arbitrary board. adjacency[i] lists the cells adjacent to cell i,
+ * each once; rows x cols must equal the number of letters and is only used to place cells on
+ * the GUI. */
+BoardGraph customBoardGraph(const Vector<char>& letters, const Vector<Vector<int>>& adjacency,
+                            int rows, int cols);
+
+#endif // _boardgraph_h
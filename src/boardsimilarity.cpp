@@ -0,0 +1,222 @@
+/* BOARD SIMILARITY
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * Computes MinHash signatures and builds and reads similarity index files. The layout, in
+ * native byte order, is:
+ *     char[8]   magic "BOGGLEMH"
+ *     uint32    format version
+ *     uint32    dictionary fingerprint
+ *     uint32    board count N
+ *     uint32    MINHASH_SIZE
+ *     uint32    LSH_BANDS
+ *     uint32    padding, so that what follows is 8-byte aligned
+ *     uint32    signatures[N][MINHASH_SIZE]
+ *     for each band:
+ *         uint64    bucket keys[N], sorted
+ *         uint32    boards[N], the board with each key
+ * A band's buckets are found by binary search on its sorted keys, so queries run straight
+ * from the mapped file without building any table in memory. */
+
+#include "boardsimilarity.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "corpus.h"
+#include "error.h"
+#include "strlib.h"
+using namespace std;
+
+const char SIMILARITY_MAGIC[8] = {'B', 'O', 'G', 'G', 'L', 'E', 'M', 'H'};
+const uint32_t SIMILARITY_VERSION = 1;
+
+/* Size of the header, before the signatures. */
+const size_t SIMILARITY_HEADER_SIZE = sizeof(SIMILARITY_MAGIC) + 6 * sizeof(uint32_t);
+
+/* Number of signature entries hashed together into one bucket key. */
+const int LSH_ROWS = MINHASH_SIZE / LSH_BANDS;
+
+/*************************************************
+ *             PROTOTYPE FUNCTIONS               *
+ ************************************************/
+uint64_t mix64(uint64_t value);
+uint64_t bandKey(const MinHashSignature& signature, int band);
+template <typename T>
+T loadValue(const char* bytes, size_t index);
+template <typename T>
+void writeValues(ostream& output, const T* values, size_t count);
+
+
+/*************************************************
+ *                  FUNCTIONS                    *
+ ************************************************/
+
+/* Hash function k maps a word id to the high half of mix64(id + seed k), where the seeds are
+ * themselves spread out by mix64 so that the functions are independent of each other. */
+MinHashSignature minHashSignature(const Vector<int>& wordIds) {
+    static const vector<uint64_t> seeds = [] {
+        vector<uint64_t> values(MINHASH_SIZE);
+        for(int k = 0; k < MINHASH_SIZE; k++) {
+            values[k] = mix64(k + 1);
+        }
+        return values;
+    }();
+    MinHashSignature signature;
+    fill(begin(signature.values), end(signature.values), UINT32_MAX);
+    for(int id : wordIds) {
+        for(int k = 0; k < MINHASH_SIZE; k++) {
+            uint32_t hash = mix64(uint64_t(id) + seeds[k]) >> 32;
+            signature.values[k] = min(signature.values[k], hash);
+        }
+    }
+    return signature;
+}
+
+double estimatedSimilarity(const MinHashSignature& a, const MinHashSignature& b) {
+    int matches = 0;
+    for(int k = 0; k < MINHASH_SIZE; k++) {
+        matches += a.values[k] == b.values[k];
+    }
+    return double(matches) / MINHASH_SIZE;
+}
+
+/* The signatures are kept in memory while the corpus is solved, and each band's
+ * (key, board) pairs are then sorted by key and written out. */
+void buildSimilarityIndex(const Vector<string>& boards, const DictionaryTrie& trie,
+                          const string& filename, int threads) {
+    vector<MinHashSignature> signatures(boards.size());
+    solveCorpus(boards, trie, SolveOptions(), threads,
+                [&](int board, const Vector<int>& wordIds, const Vector<int>&) {
+        signatures[board] = minHashSignature(wordIds);
+    });
+    ofstream output(filename.c_str(), ios::binary | ios::trunc);
+    if(!output) {
+        error("buildSimilarityIndex: cannot create " + filename);
+    }
+    uint32_t header[6] = {SIMILARITY_VERSION, trie.fingerprint(), (uint32_t) boards.size(),
+                          MINHASH_SIZE, LSH_BANDS, 0};
+    output.write(SIMILARITY_MAGIC, sizeof(SIMILARITY_MAGIC));
+    writeValues(output, header, 6);
+    writeValues(output, signatures.data(), signatures.size());
+    vector<pair<uint64_t, uint32_t>> buckets(boards.size());
+    vector<uint64_t> keys(boards.size());
+    vector<uint32_t> ids(boards.size());
+    for(int band = 0; band < LSH_BANDS; band++) {
+        for(int board = 0; board < boards.size(); board++) {
+            buckets[board] = {bandKey(signatures[board], band), board};
+        }
+        sort(buckets.begin(), buckets.end());
+        for(size_t i = 0; i < buckets.size(); i++) {
+            keys[i] = buckets[i].first;
+            ids[i] = buckets[i].second;
+        }
+        writeValues(output, keys.data(), keys.size());
+        writeValues(output, ids.data(), ids.size());
+    }
+    if(!output) {
+        error("buildSimilarityIndex: cannot write " + filename);
+    }
+}
+
+SimilarityIndex::SimilarityIndex(const string& filename) : file(filename) {
+    if(file.size() < SIMILARITY_HEADER_SIZE ||
+       memcmp(file.data(), SIMILARITY_MAGIC, sizeof(SIMILARITY_MAGIC)) != 0) {
+        error("SimilarityIndex: " + filename + " is not a similarity index");
+    }
+    const char* header = file.data() + sizeof(SIMILARITY_MAGIC);
+    if(loadValue<uint32_t>(header, 0) != SIMILARITY_VERSION ||
+       loadValue<uint32_t>(header, 3) != MINHASH_SIZE || loadValue<uint32_t>(header, 4) != LSH_BANDS) {
+        error("SimilarityIndex: " + filename + " has an unsupported format");
+    }
+    dictionaryFingerprint = loadValue<uint32_t>(header, 1);
+    boards = loadValue<uint32_t>(header, 2);
+    size_t expected = SIMILARITY_HEADER_SIZE + size_t(boards) * sizeof(MinHashSignature) +
+                      size_t(LSH_BANDS) * boards * (sizeof(uint64_t) + sizeof(uint32_t));
+    if(file.size() < expected) {
+        error("SimilarityIndex: " + filename + " is truncated");
+    }
+}
+
+MinHashSignature SimilarityIndex::signature(int board) const {
+    if(board < 0 || board >= boards) {
+        error("SimilarityIndex: board " + integerToString(board) + " is out of range");
+    }
+    return loadValue<MinHashSignature>(file.data() + SIMILARITY_HEADER_SIZE, board);
+}
+
+/* Every board found in one of the query's buckets is a candidate; the candidates are then
+ * ranked by how many signature entries they share with the query. */
+Vector<SimilarBoard> SimilarityIndex::mostSimilar(const MinHashSignature& signature, int count,
+                                                  int skipBoard) const {
+    const char* bands = file.data() + SIMILARITY_HEADER_SIZE + size_t(boards) * sizeof(MinHashSignature);
+    size_t bandSize = size_t(boards) * (sizeof(uint64_t) + sizeof(uint32_t));
+    unordered_set<int> seen;
+    vector<SimilarBoard> candidates;
+    for(int band = 0; band < LSH_BANDS; band++) {
+        const char* keys = bands + band * bandSize;
+        const char* ids = keys + size_t(boards) * sizeof(uint64_t);
+        uint64_t key = bandKey(signature, band);
+        size_t low = 0;
+        size_t high = boards;
+        while(low < high) {
+            size_t middle = (low + high) / 2;
+            if(loadValue<uint64_t>(keys, middle) < key) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        for(size_t i = low; i < (size_t) boards && loadValue<uint64_t>(keys, i) == key; i++) {
+            int board = loadValue<uint32_t>(ids, i);
+            if(board != skipBoard && seen.insert(board).second) {
+                candidates.push_back({board, estimatedSimilarity(signature, this->signature(board))});
+            }
+        }
+    }
+    int kept = min(max(count, 0), (int) candidates.size());
+    partial_sort(candidates.begin(), candidates.begin() + kept, candidates.end(),
+                 [](const SimilarBoard& a, const SimilarBoard& b) {
+        return a.similarity > b.similarity || (a.similarity == b.similarity && a.board < b.board);
+    });
+    Vector<SimilarBoard> result;
+    for(int i = 0; i < kept; i++) {
+        result.add(candidates[i]);
+    }
+    return result;
+}
+
+/* The splitmix64 finalizer, which spreads every input bit across the whole output. */
+uint64_t mix64(uint64_t value) {
+    value += 0x9e3779b97f4a7c15ULL;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+/* Hashes the rows of one band, together with the band number so that equal rows in
+ * different bands do not produce the same key. */
+uint64_t bandKey(const MinHashSignature& signature, int band) {
+    uint64_t key = mix64(band);
+    for(int row = 0; row < LSH_ROWS; row++) {
+        key = mix64(key ^ signature.values[band * LSH_ROWS + row]);
+    }
+    return key;
+}
+
+/* Reads the value at the given index of an array of T starting at bytes, which need not be
+ * aligned. */
+template <typename T>
+T loadValue(const char* bytes, size_t index) {
+    T value;
+    memcpy(&value, bytes + index * sizeof(T), sizeof(T));
+    return value;
+}
+
+/* Writes count values as raw bytes. */
+template <typename T>
+void writeValues(ostream& output, const T* values, size_t count) {
+    output.write(reinterpret_cast<const char*>(values), count * sizeof(T));
+}
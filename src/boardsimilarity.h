@@ -0,0 +1,86 @@
+/* BOARD SIMILARITY
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * Finds boards whose word lists are nearly the same, so that near-duplicate puzzles are not
+ * served twice. Every solved board is summarized by a MinHash signature of its set of word
+ * ids: for each of MINHASH_SIZE hash functions, the smallest hash of any of its words. Two
+ * boards agree on a signature entry with probability equal to the Jaccard similarity of their
+ * word sets, so comparing signatures estimates similarity without comparing the sets.
+ *
+ * To avoid comparing a query against every board, the signatures are also split into
+ * LSH_BANDS bands, and each band is hashed to a bucket key. Boards sharing any bucket with
+ * the query are the candidates, and only they are ranked by their full signatures. A pair
+ * with similarity s shares at least one bucket with probability 1 - (1 - s^r)^b, for r rows
+ * per band and b bands, so similar boards are almost always found and dissimilar ones are
+ * almost never examined. */
+
+#ifndef _boardsimilarity_h
+#define _boardsimilarity_h
+
+#include <cstdint>
+#include <string>
+#include "dictionarytrie.h"
+#include "mappedfile.h"
+#include "vector.h"
+
+/* Number of hash functions in a signature. */
+const int MINHASH_SIZE = 64;
+
+/* Number of LSH bands the signature is split into; each band has
+ * MINHASH_SIZE / LSH_BANDS rows. */
+const int LSH_BANDS = 16;
+
+struct MinHashSignature {
+    uint32_t values[MINHASH_SIZE];
+};
+
+struct SimilarBoard {
+    int board;
+    double similarity;   // estimated Jaccard similarity of the word sets
+};
+
+/* Returns the signature of a set of word ids. */
+MinHashSignature minHashSignature(const Vector<int>& wordIds);
+
+/* Returns the fraction of entries on which the signatures agree. */
+double estimatedSimilarity(const MinHashSignature& a, const MinHashSignature& b);
+
+/* Solves every board of the corpus under the classic rules and writes the signatures and
+ * their LSH buckets to the given file, using the given number of threads for the solving. */
+void buildSimilarityIndex(const Vector<std::string>& boards, const DictionaryTrie& trie,
+                          const std::string& filename, int threads);
+
+class SimilarityIndex {
+public:
+    /* Opens an index file written by buildSimilarityIndex. Throws an ErrorException if the
+     * file is not a similarity index. */
+    SimilarityIndex(const std::string& filename);
+
+    /* Returns the fingerprint of the dictionary the index was built with. */
+    uint32_t fingerprint() const {
+        return dictionaryFingerprint;
+    }
+
+    int boardCount() const {
+        return boards;
+    }
+
+    /* Returns the stored signature of the given board. */
+    MinHashSignature signature(int board) const;
+
+    /* Returns up to count boards most similar to the given signature, most similar first.
+     * Only boards sharing an LSH bucket with the signature are considered, and the board
+     * with id skipBoard (the query board itself, say) is left out. */
+    Vector<SimilarBoard> mostSimilar(const MinHashSignature& signature, int count, int skipBoard = -1) const;
+
+private:
+    SimilarityIndex(const SimilarityIndex&) = delete;
+    SimilarityIndex& operator=(const SimilarityIndex&) = delete;
+
+    MappedFile file;
+    uint32_t dictionaryFingerprint;
+    int boards;
+};
+
+#endif // _boardsimilarity_h
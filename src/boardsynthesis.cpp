@@ -0,0 +1,315 @@
+/* BOARD SYNTHESIS
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * Implements synthesizeBoard. The words are placed longest first, since long words are the
+ * hardest to fit, and every attempt shuffles the start cells and the order neighbors are
+ * tried in so that restarts and threads explore different embeddings. */
+
+#include "boardsynthesis.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include "boardgraph.h"
+#include "boggleconstants.h"
+#include "error.h"
+#include "strlib.h"
+#include "wordsolver.h"
+using namespace std;
+
+/* No die is matched to the cell, or no cell to the die. */
+const int UNMATCHED = -1;
+
+/* The state of one embedding attempt. letters[cell] is 0 for cells no word has used yet. When
+ * there is a die set, dieOfCell and cellOfDie hold a matching that gives every lettered cell
+ * a die with that letter on one of its faces. */
+struct Embedding {
+    const BoardGraph& graph;
+    const vector<uint32_t>& dieLetters;   // mask of the letters on each die's faces
+    vector<string> words;
+    vector<char> letters;
+    vector<int> pathWord;                 // 1 + index of the latest word whose path uses the cell
+    vector<int> dieOfCell;
+    vector<int> cellOfDie;
+    mt19937& random;
+    long steps;
+    long maxSteps;
+    const atomic<bool>& stop;
+
+    Embedding(const BoardGraph& graph, const vector<uint32_t>& dieLetters, mt19937& random,
+              long maxSteps, const atomic<bool>& stop)
+        : graph(graph), dieLetters(dieLetters), letters(graph.cellCount(), 0),
+          pathWord(graph.cellCount(), 0), dieOfCell(graph.cellCount(), UNMATCHED),
+          cellOfDie(dieLetters.size(), UNMATCHED), random(random), steps(0),
+          maxSteps(maxSteps), stop(stop) {}
+
+    bool outOfTime() const {
+        return steps > maxSteps || stop;
+    }
+};
+
+/*************************************************
+ *             PROTOTYPE FUNCTIONS               *
+ ************************************************/
+void synthesizeInThread(const BoardGraph& graph, const Vector<string>& words, const Vector<int>& wordIds,
+                        const DictionaryTrie& trie, const vector<uint32_t>& dieLetters,
+                        const SynthesisOptions& options, unsigned seed, atomic<bool>& stop,
+                        mutex& resultLock, vector<char>& result);
+bool placeWords(Embedding& embedding, int word);
+bool extendPath(Embedding& embedding, int word, int position, int cell);
+bool assignLetter(Embedding& embedding, int cell, char letter);
+void clearLetter(Embedding& embedding, int cell);
+bool augment(Embedding& embedding, int cell, vector<char>& triedDice);
+void fillRemainingCells(Embedding& embedding);
+bool containsAll(const BoardGraph& graph, const vector<char>& letters, const DictionaryTrie& trie,
+                 const Vector<int>& wordIds);
+
+
+/*************************************************
+ *                  FUNCTIONS                    *
+ ************************************************/
+
+/* The words and dice are validated and the board topology is built before any thread starts;
+ * the threads then only share read-only data, the stop flag, and the result slot. */
+bool synthesizeBoard(const Vector<string>& words, const DictionaryTrie& trie,
+                     const SynthesisOptions& options, Grid<char>& board) {
+    Vector<string> required;
+    Vector<int> wordIds;
+    for(string word : words) {
+        word = toUpperCase(trim(word));
+        int node = trie.find(word);
+        if(word.empty() || node == DictionaryTrie::NONE || trie.wordId(node) == DictionaryTrie::NONE) {
+            error("synthesizeBoard: \"" + word + "\" is not in the dictionary");
+        }
+        required.add(word);
+        wordIds.add(trie.wordId(node));
+    }
+    if(!options.dice.isEmpty() && options.dice.size() != options.size * options.size) {
+        error("synthesizeBoard: a " + integerToString(options.size) + "x" + integerToString(options.size) +
+              " board needs " + integerToString(options.size * options.size) + " dice but " +
+              integerToString(options.dice.size()) + " were given");
+    }
+    vector<uint32_t> dieLetters;
+    for(string die : options.dice) {
+        uint32_t mask = 0;
+        for(char face : toUpperCase(die)) {
+            if(letterIndex(face) != -1) {
+                mask |= uint32_t(1) << letterIndex(face);
+            }
+        }
+        if(mask == 0) {
+            error("synthesizeBoard: die \"" + die + "\" has no letter faces");
+        }
+        dieLetters.push_back(mask);
+    }
+    board.resize(options.size, options.size);
+    BoardGraph graph = gridBoardGraph(board);
+    atomic<bool> stop(false);
+    mutex resultLock;
+    vector<char> result;
+    random_device seeds;
+    vector<thread> workers;
+    for(int i = 0; i < max(1, options.threads); i++) {
+        workers.push_back(thread(synthesizeInThread, cref(graph), cref(required), cref(wordIds), cref(trie),
+                                 cref(dieLetters), cref(options), seeds(), ref(stop), ref(resultLock),
+                                 ref(result)));
+    }
+    for(thread& worker : workers) {
+        worker.join();
+    }
+    if(result.empty()) {
+        return false;
+    }
+    for(int cell = 0; cell < graph.cellCount(); cell++) {
+        board[graph.row(cell)][graph.col(cell)] = result[cell];
+    }
+    return true;
+}
+
+/* Runs randomized attempts until one produces a verified board, another thread succeeds, or
+ * the attempts run out. Words of equal length are shuffled before being placed longest first. */
+void synthesizeInThread(const BoardGraph& graph, const Vector<string>& words, const Vector<int>& wordIds,
+                        const DictionaryTrie& trie, const vector<uint32_t>& dieLetters,
+                        const SynthesisOptions& options, unsigned seed, atomic<bool>& stop,
+                        mutex& resultLock, vector<char>& result) {
+    mt19937 random(seed);
+    for(int attempt = 0; attempt < options.attempts && !stop; attempt++) {
+        Embedding embedding(graph, dieLetters, random, options.stepsPerAttempt, stop);
+        embedding.words.assign(words.begin(), words.end());
+        shuffle(embedding.words.begin(), embedding.words.end(), random);
+        stable_sort(embedding.words.begin(), embedding.words.end(), [](const string& a, const string& b) {
+            return a.length() > b.length();
+        });
+        if(!placeWords(embedding, 0)) {
+            continue;
+        }
+        fillRemainingCells(embedding);
+        if(containsAll(graph, embedding.letters, trie, wordIds)) {
+            lock_guard<mutex> guard(resultLock);
+            if(!stop) {
+                result = embedding.letters;
+                stop = true;
+            }
+        }
+    }
+}
+
+/* Places words[word] and every word after it, trying each cell as the start of the path. */
+bool placeWords(Embedding& embedding, int word) {
+    if(word == (int) embedding.words.size()) {
+        return true;
+    }
+    vector<int> starts(embedding.graph.cellCount());
+    for(int cell = 0; cell < (int) starts.size(); cell++) {
+        starts[cell] = cell;
+    }
+    shuffle(starts.begin(), starts.end(), embedding.random);
+    for(int cell : starts) {
+        if(embedding.outOfTime()) {
+            return false;
+        }
+        if(extendPath(embedding, word, 0, cell)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Puts the letter at the given position of the word on cell, then continues the path from
+ * there. Neighbors already holding the next letter are tried first, so words share cells
+ * whenever they can and leave more of the board free for the words still to come. */
+bool extendPath(Embedding& embedding, int word, int position, int cell) {
+    const string& text = embedding.words[word];
+    embedding.steps++;
+    if(embedding.pathWord[cell] == word + 1 || embedding.outOfTime()) {
+        return false;
+    }
+    bool placed = embedding.letters[cell] == 0;
+    if(placed) {
+        if(!assignLetter(embedding, cell, text[position])) {
+            return false;
+        }
+    } else if(embedding.letters[cell] != text[position]) {
+        return false;
+    }
+    int previousWord = embedding.pathWord[cell];
+    embedding.pathWord[cell] = word + 1;
+    bool done;
+    if(position + 1 == (int) text.length()) {
+        done = placeWords(embedding, word + 1);
+    } else {
+        const BoardGraph& graph = embedding.graph;
+        vector<int> next(graph.neighbors.begin() + graph.offsets[cell],
+                         graph.neighbors.begin() + graph.offsets[cell + 1]);
+        shuffle(next.begin(), next.end(), embedding.random);
+        stable_partition(next.begin(), next.end(), [&](int neighbor) {
+            return embedding.letters[neighbor] == text[position + 1];
+        });
+        done = false;
+        for(int i = 0; i < (int) next.size() && !done; i++) {
+            done = extendPath(embedding, word, position + 1, next[i]);
+        }
+    }
+    embedding.pathWord[cell] = previousWord;
+    if(!done && placed) {
+        clearLetter(embedding, cell);
+    }
+    return done;
+}
+
+/* Writes the letter on an empty cell. With a die set, the cell must also be matched to a
+ * die showing that letter, possibly by moving other cells to different dice. */
+bool assignLetter(Embedding& embedding, int cell, char letter) {
+    embedding.letters[cell] = letter;
+    if(embedding.dieLetters.empty()) {
+        return true;
+    }
+    vector<char> triedDice(embedding.dieLetters.size(), false);
+    if(augment(embedding, cell, triedDice)) {
+        return true;
+    }
+    embedding.letters[cell] = 0;
+    return false;
+}
+
+/* Empties a cell. Releasing its die leaves a valid matching for the other cells. */
+void clearLetter(Embedding& embedding, int cell) {
+    embedding.letters[cell] = 0;
+    if(embedding.dieOfCell[cell] != UNMATCHED) {
+        embedding.cellOfDie[embedding.dieOfCell[cell]] = UNMATCHED;
+        embedding.dieOfCell[cell] = UNMATCHED;
+    }
+}
+
+/* Looks for an augmenting path from an unmatched cell: a die with the cell's letter that is
+ * either free or whose cell can move to another die. */
+bool augment(Embedding& embedding, int cell, vector<char>& triedDice) {
+    uint32_t letter = uint32_t(1) << letterIndex(embedding.letters[cell]);
+    for(int die = 0; die < (int) embedding.dieLetters.size(); die++) {
+        if((embedding.dieLetters[die] & letter) && !triedDice[die]) {
+            triedDice[die] = true;
+            int owner = embedding.cellOfDie[die];
+            if(owner == UNMATCHED || augment(embedding, owner, triedDice)) {
+                embedding.cellOfDie[die] = cell;
+                embedding.dieOfCell[cell] = die;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/* Cells no word uses get a random face of one of the leftover dice, or, without a die set,
+ * a random face of a random Super Big Boggle cube. */
+void fillRemainingCells(Embedding& embedding) {
+    vector<int> freeDice;
+    for(int die = 0; die < (int) embedding.cellOfDie.size(); die++) {
+        if(embedding.cellOfDie[die] == UNMATCHED) {
+            freeDice.push_back(die);
+        }
+    }
+    shuffle(freeDice.begin(), freeDice.end(), embedding.random);
+    for(int cell = 0; cell < (int) embedding.letters.size(); cell++) {
+        if(embedding.letters[cell] != 0) {
+            continue;
+        }
+        uint32_t faces;
+        if(embedding.dieLetters.empty()) {
+            string cube = LETTER_CUBES_SUPER_BIG[embedding.random() % LETTER_CUBES_SUPER_BIG.size()];
+            faces = 0;
+            for(char face : cube) {
+                faces |= uint32_t(1) << letterIndex(toUpperCase(face));
+            }
+        } else {
+            faces = embedding.dieLetters[freeDice.back()];
+            freeDice.pop_back();
+        }
+        vector<int> choices;
+        for(; faces != 0; faces &= faces - 1) {
+            choices.push_back(__builtin_ctz(faces));
+        }
+        embedding.letters[cell] = 'A' + choices[embedding.random() % choices.size()];
+    }
+}
+
+/* Solves the finished board and checks that every required word was found. The graph is the
+ * empty board's topology, so the check does not touch the shared topology cache. */
+bool containsAll(const BoardGraph& graph, const vector<char>& letters, const DictionaryTrie& trie,
+                 const Vector<int>& wordIds) {
+    BoardGraph filled = graph;
+    for(int cell = 0; cell < filled.cellCount(); cell++) {
+        filled.letters[cell] = letters[cell];
+    }
+    SolveOptions options;
+    options.minLength = 1;
+    Vector<int> found = solveBoard(filled, trie, options);
+    for(int id : wordIds) {
+        if(!binary_search(found.begin(), found.end(), id)) {
+            return false;
+        }
+    }
+    return true;
+}
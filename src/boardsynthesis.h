@@ -0,0 +1,38 @@
+/* BOARD SYNTHESIS
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * Builds boards on which a required list of words can all be formed, for themed puzzles.
+ * Each word is embedded as a path on an empty board, reusing cells already holding the right
+ * letter where possible, and the search backtracks whenever a word cannot be placed. When a
+ * die set is given, every lettered cell must show a face of a different die, which is checked
+ * as a bipartite matching between cells and dice after every letter placed. The cells left
+ * over are filled at random, and the finished board is verified with the solver. Each thread
+ * explores its own randomized embeddings, and the first verified board wins. */
+
+#ifndef _boardsynthesis_h
+#define _boardsynthesis_h
+
+#include <string>
+#include "dictionarytrie.h"
+#include "grid.h"
+#include "vector.h"
+
+struct SynthesisOptions {
+    int size;                  // the board is size x size
+    Vector<std::string> dice;  // faces of each die, or empty to allow any letters
+    int threads;               // number of independent searches to run
+    int attempts;              // randomized restarts per thread before giving up
+    long stepsPerAttempt;      // placement steps before an attempt is abandoned
+
+    SynthesisOptions() : size(4), threads(1), attempts(200), stepsPerAttempt(100000) {}
+};
+
+/* Searches for a board containing every one of the required words and stores it in board,
+ * which is resized to the requested size. Returns false if no board was found within the
+ * search budget. Throws an ErrorException if a word is not in the dictionary or the die set
+ * does not have one die per cell. */
+bool synthesizeBoard(const Vector<std::string>& words, const DictionaryTrie& trie,
+                     const SynthesisOptions& options, Grid<char>& board);
+
+#endif // _boardsynthesis_h
@@ -16,10 +16,13 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <vector>
 #include "console.h"
 #include "filelib.h"
 #include "grid.h"
 #include "lexicon.h"
+#include "map.h"
 #include "random.h"
 #include "set.h"
 #include "shuffle.h"
@@ -27,25 +30,59 @@
 #include "strlib.h"
 #include "vector.h"
 #include "gui.h"
+#include "boardgraph.h"
+#include "boardsynthesis.h"
+#include "dictionarytrie.h"
+#include "difficulty.h"
+#include "gamelog.h"
+#include "gamerules.h"
+#include "hintengine.h"
+#include "wordsolver.h"
 using namespace std;
 
+/* Edge length of the 3-D cube board. */
+const int CUBE_SIZE = 4;
+
+/* Boards with more cells than the largest flat board are searched on every core. */
+const int THREADED_BOARD_CELLS = BOARD_SIZE_MAX * BOARD_SIZE_MAX;
+
+/* Typed instead of a word to ask for a hint. */
+const string HINT_COMMAND = "?";
+
 /*************************************************
  *             PROTOTYPE FUNCTIONS               *
  ************************************************/
 void intro();
-void promptBoard(Grid<char>& board);
+BoardGraph promptBoard(Grid<char>& board, Lexicon& dictionary);
+BoardGraph promptWraparound(Grid<char>& board);
+DiceRule promptDiceRule();
+GameRules promptRules();
+WordTier promptOpponent(Lexicon& dictionary);
 void generateRandomBoard(Grid<char>& board);
+BoardGraph generateRandomCube();
 void generateManualBoard(Grid<char>& board);
-string getWord(Lexicon& dictionary);
-bool inBounds(int row, int col);
-int getPoints(string word);
-Set<string> humanTurn(Grid<char>& board, Lexicon& dictionary, int humanScore);
-void computerTurn(Grid<char>& board, Lexicon& dictionary, Set<string>& humanWords, int humanScore);
+bool generateThemedBoard(Grid<char>& board, Lexicon& dictionary);
+string getWord(Lexicon& dictionary, const GameRules& rules, GameLogWriter& log);
+Set<string> humanTurn(const BoardGraph& graph, Lexicon& dictionary, DiceRule rule, const GameRules& rules,
+                      int& humanScore, HintEngine& hints, GameLogWriter& log);
+int computerTurn(Lexicon& dictionary, const GameRules& rules, const Vector<int>& solution,
+                  const Map<int, string>& spellings, Set<string>& humanWords, int humanScore,
+                  WordTier opponent);
 bool humanWordSearch(Grid<char>& board, string word);
+bool humanWordSearch(const BoardGraph& graph, string word, DiceRule rule = USE_EACH_CUBE_ONCE);
 Set<string> computerWordSearch(Grid<char>& board, Lexicon& dictionary, Set<string>& humanWords);
-bool searchForWord(Grid<char> board, string word, string potentialWord, int row, int col);
-Set<string> exhaustiveSearch(Grid<char> board, Lexicon& dictionary, Set<string>& humanWords,
-                             string potentialWord, int row, int col);
+Set<string> computerWordSearch(const BoardGraph& graph, Lexicon& dictionary, Set<string>& humanWords,
+                               DiceRule rule = USE_EACH_CUBE_ONCE);
+Set<string> computerWordSearch(const BoardGraph& graph, Lexicon& dictionary, Set<string>& humanWords,
+                               DiceRule rule, Map<string, string>& wildcardSpellings);
+Set<string> computerWordSearch(Lexicon& dictionary, const Vector<int>& solution,
+                               const Map<int, string>& spellings, Set<string>& humanWords,
+                               Map<string, string>& wildcardSpellings);
+Vector<int> solveGameBoard(const BoardGraph& graph, Lexicon& dictionary, DiceRule rule,
+                           const GameRules& rules, Map<int, string>& spellings);
+void highlightCell(const BoardGraph& graph, int cell);
+bool searchForWord(const BoardGraph& graph, const string& word, vector<bool>& visited, int start);
+const DictionaryTrie& compiledDictionary(Lexicon& dictionary);
 
 
 /*************************************************
@@ -56,13 +93,24 @@ int main() {
     Grid<char> board(BOARD_SIZE, BOARD_SIZE);
     Lexicon dictionary(DICTIONARY_FILE);
     intro();
+    DiceRule rule = promptDiceRule();
+    GameRules rules = promptRules();
+    WordTier opponent = promptOpponent(dictionary);
+    GameLogWriter log(GAME_LOG_FILE);
     do {
         gui::initialize(BOARD_SIZE, BOARD_SIZE);
         cout << endl;
-        promptBoard(board);
+        BoardGraph graph = promptBoard(board, dictionary);
+        log.startGame(graph, rule, rules, compiledDictionary(dictionary).fingerprint());
+        Map<int, string> spellings;
+        Vector<int> solution = solveGameBoard(graph, dictionary, rule, rules, spellings);
+        HintEngine hints(graph, compiledDictionary(dictionary), solution, rule);
         int humanScore = 0;
-        Set<string> humanWords = humanTurn(board, dictionary, humanScore);
-        computerTurn(board, dictionary, humanWords, humanScore);
+        Set<string> humanWords = humanTurn(graph, dictionary, rule, rules, humanScore, hints, log);
+        log.recordSolution(solution);
+        int computerScore = computerTurn(dictionary, rules, solution, spellings, humanWords, humanScore,
+                                         opponent);
+        log.endGame(humanScore, computerScore);
     } while (getYesOrNo("Play again? "));
     cout << "Have a nice day." << endl;
     return 0;
@@ -80,13 +128,76 @@ void intro() {
     getLine("Press Enter to begin the game ...");
 }
 
-/* Prompts the user to have a random board generated or to enter a manual configuration. */
-void promptBoard(Grid<char>& board) {
+/* Prompts the user to play on the 3-D cube or on a flat board. A flat board is either built
+ * around a list of words, generated randomly, or entered as a manual configuration. */
+BoardGraph promptBoard(Grid<char>& board, Lexicon& dictionary) {
+    if(getYesOrNo("Play 3-D Boggle on a 4x4x4 cube? ")) {
+        return generateRandomCube();
+    }
+    if(getYesOrNo("Build the board around a list of words? ") && generateThemedBoard(board, dictionary)) {
+        return promptWraparound(board);
+    }
     if(getYesOrNo("Generate a random board? ")) {
         generateRandomBoard(board);
     } else {
         generateManualBoard(board);
     }
+    return promptWraparound(board);
+}
+
+/* The user chooses whether words may wrap around from one edge of the board to the opposite
+ * edge, and the board is converted to the matching graph. */
+BoardGraph promptWraparound(Grid<char>& board) {
+    if(getYesOrNo("Allow words to wrap around the edges? ")) {
+        return torusBoardGraph(board);
+    }
+    return gridBoardGraph(board);
+}
+
+/* The user chooses whether a word may reuse a cube, as long as it does not use the same
+ * cube twice in a row, or else whether to play anagrams, where the cubes of a word need not
+ * touch. */
+DiceRule promptDiceRule() {
+    if(getYesOrNo("Allow words to reuse cubes (just not twice in a row)? ")) {
+        return NO_IMMEDIATE_REUSE;
+    }
+    if(getYesOrNo("Play anagrams (any cubes, in any order)? ")) {
+        return LETTER_BAG;
+    }
+    return USE_EACH_CUBE_ONCE;
+}
+
+/* The user chooses the scoring rules for the session from the predefined rule sets. */
+GameRules promptRules() {
+    Vector<GameRules> rules = ruleSets();
+    if(!getYesOrNo("Play with different scoring rules? ")) {
+        return rules[0];
+    }
+    for(int i = 0; i < rules.size(); i++) {
+        cout << i + 1 << ". " << rules[i].name << endl;
+    }
+    int choice = getInteger("Choose a rule set: ");
+    while(choice < 1 || choice > rules.size()) {
+        cout << "There is no rule set " << choice << ". Try again." << endl;
+        choice = getInteger("Choose a rule set: ");
+    }
+    return rules[choice - 1];
+}
+
+/* With a frequency list, the user may pick an easier computer opponent, which only knows the
+ * more common words. Without one every word counts as common, so there is nothing to pick. */
+WordTier promptOpponent(Lexicon& dictionary) {
+    if(!compiledDictionary(dictionary).hasWordTiers() || !getYesOrNo("Play against an easier computer? ")) {
+        return RARE_WORD;
+    }
+    cout << "1. Easy: knows only the most common words" << endl;
+    cout << "2. Medium: knows the familiar words too" << endl;
+    int choice = getInteger("Choose an opponent: ");
+    while(choice < 1 || choice > 2) {
+        cout << "There is no opponent " << choice << ". Try again." << endl;
+        choice = getInteger("Choose an opponent: ");
+    }
+    return choice == 1 ? COMMON_WORD : FAMILIAR_WORD;
 }
 
 /* A random board layout is generated from the fixed cubes and board size. */
@@ -108,7 +219,35 @@ void generateRandomBoard(Grid<char>& board) {
     gui::labelCubes(board);
 }
 
-/* A manual board configuration is accepted from the user and used as the game board. */
+/* A random cube is rolled from the standard cubes, reusing the set once for every layer.
+ * The cube is too big for the GUI, so its layers are only printed to the console. */
+BoardGraph generateRandomCube() {
+    Vector<string> cubes;
+    for(int layer = 0; layer < CUBE_SIZE; layer++) {
+        for(string cube : LETTER_CUBES) {
+            cubes.add(cube);
+        }
+    }
+    shuffle(cubes);
+    Vector<char> letters;
+    for(string cube : cubes) {
+        letters.add(shuffle(cube)[0]);
+    }
+    for(int layer = 0; layer < CUBE_SIZE; layer++) {
+        cout << "Layer " << layer + 1 << ":" << endl;
+        for(int i = 0; i < CUBE_SIZE; i++) {
+            for(int j = 0; j < CUBE_SIZE; j++) {
+                cout << letters[(layer * CUBE_SIZE + i) * CUBE_SIZE + j];
+            }
+            cout << endl;
+        }
+    }
+    cout << endl;
+    return cubeBoardGraph(letters, CUBE_SIZE);
+}
+
+/* A manual board configuration is accepted from the user and used as the game board.
+ * A '?' or '*' places a blank cube, which can stand for any letter. */
 void generateManualBoard(Grid<char>& board) {
     string choices = getLine("Type the " + integerToString(NUM_CUBES) + " letters on the board: ");
     while(choices.length() != NUM_CUBES) {
@@ -118,6 +257,9 @@ void generateManualBoard(Grid<char>& board) {
     int cubeCounter = 0;
     for(int i = 0; i < BOARD_SIZE; i++) {
         for(int j = 0; j < BOARD_SIZE; j++) {
+            if(choices[cubeCounter] == '*') {
+                choices[cubeCounter] = BOARD_WILDCARD;
+            }
             board[i][j] = toUpperCase(choices[cubeCounter]);
             cubeCounter++;
             cout << board[i][j];
@@ -128,53 +270,76 @@ void generateManualBoard(Grid<char>& board) {
     gui::labelCubes(toUpperCase(choices));
 }
 
-/* Each string the user enters is checked to make sure it is in the English dictionary and
- * meets requirements for minimum word length. */
-string getWord(Lexicon& dictionary) {
-    string word = toUpperCase(getLine("Type a word (or Enter to stop): "));
-    while((word.length() < MIN_WORD_LENGTH && word != "") ||
-          (!dictionary.contains(word) && word != "")) {
-        if(word.length() < MIN_WORD_LENGTH && word != "") {
-            cout << "The word must have at least " << MIN_WORD_LENGTH << " letters." << endl;
-            word = getLine("Type a word (or Enter to stop): ");
-        }
-        if(!dictionary.contains(word) && word != "") {
-            cout << "That word is not found in the dictionary." << endl;
-            word = getLine("Type a word (or Enter to stop): ");
-        }
-    }
-    return toUpperCase(word);
-}
-
-/* This fuction outputs a score based on the length of an input word. */
-int getPoints(string word) {
-    if(word.length() == 4) {
-        return 1;
+/* The user lists words that must all be formable, and a board containing them is searched
+ * for on every core, optionally using only the standard cubes. Returns false, after telling
+ * the user, if no such board was found. */
+bool generateThemedBoard(Grid<char>& board, Lexicon& dictionary) {
+    SynthesisOptions options;
+    options.size = BOARD_SIZE;
+    options.threads = max(1u, thread::hardware_concurrency());
+    if(getYesOrNo("Use only the standard cubes? ")) {
+        options.dice = LETTER_CUBES;
     }
-    if(word.length() == 5) {
-        return 2;
-    }
-    if(word.length() == 6) {
-        return 3;
+    Vector<string> words;
+    while(words.isEmpty()) {
+        for(string word : stringSplit(getLine("Type the words the board must contain: "), " ")) {
+            if(word != "" && !dictionary.contains(word)) {
+                cout << "\"" << word << "\" is not in the dictionary. Try again." << endl;
+                words.clear();
+                break;
+            } else if(word != "") {
+                words.add(word);
+            }
+        }
     }
-    if(word.length() == 7) {
-        return 5;
+    if(!synthesizeBoard(words, compiledDictionary(dictionary), options, board)) {
+        cout << "No board containing all of those words was found." << endl;
+        return false;
     }
-    if(word.length() > 7) {
-        return 11;
+    for(int i = 0; i < BOARD_SIZE; i++) {
+        for(int j = 0; j < BOARD_SIZE; j++) {
+            cout << board[i][j];
+        }
+        cout << endl;
     }
-    return 0;
+    cout << endl;
+    gui::labelCubes(board);
+    return true;
 }
 
-/* This function returns true if the input row/column are in the bounds of the board. */
-bool inBounds(int row, int col) {
-    return row >= 0 && row < BOARD_SIZE && col >= 0 && col < BOARD_SIZE;
+/* Each string the user enters is checked to make sure it is in the English dictionary and
+ * meets the rules' requirements for word length; every rejected word is logged and the user
+ * is asked again. A request for a hint is passed through at any prompt. */
+string getWord(Lexicon& dictionary, const GameRules& rules, GameLogWriter& log) {
+    string prompt = "Type a word (or Enter to stop, " + HINT_COMMAND + " for a hint): ";
+    while(true) {
+        string word = toUpperCase(getLine(prompt));
+        if(word == "" || word == HINT_COMMAND) {
+            return word;
+        }
+        if(!rules.allows(word)) {
+            log.recordWord(word, WORD_REJECTED);
+            cout << "The word must have at least " << rules.minLength;
+            if(rules.maxLength > 0) {
+                cout << " and at most " << rules.maxLength;
+            }
+            cout << " letters." << endl;
+        } else if(!dictionary.contains(word)) {
+            log.recordWord(word, WORD_REJECTED);
+            cout << "That word is not found in the dictionary." << endl;
+        } else {
+            return word;
+        }
+    }
 }
 
 /* The user is allowed to enter words which are verified by the word search algorithm.
  * The user is notified and reprompted if the word cannot be formed on the board. The
- * words they find are displayed to the GUI along with their tallied score. */
-Set<string> humanTurn(Grid<char>& board, Lexicon& dictionary, int humanScore) {
+ * words they find are displayed to the GUI along with their tallied score, and are marked
+ * found in the hint engine so that hints are always about words still to be found. Every
+ * word and hint request is logged with its verdict, and humanScore is left at the final score. */
+Set<string> humanTurn(const BoardGraph& graph, Lexicon& dictionary, DiceRule rule, const GameRules& rules,
+                      int& humanScore, HintEngine& hints, GameLogWriter& log) {
     Set<string> wordList;
     cout << "It's your turn!" << endl;
     string word = " ";
@@ -182,16 +347,28 @@ Set<string> humanTurn(Grid<char>& board, Lexicon& dictionary, int humanScore) {
         gui::clearHighlighting();
         cout << "Your words: " << wordList << endl;
         cout << "Your score: " << humanScore << endl;
-        word = getWord(dictionary);
-        if(wordList.contains(word)) {
+        word = getWord(dictionary, rules, log);
+        if(word == HINT_COMMAND) {
+            log.recordWord(word, HINT_REQUESTED);
+            Hint hint = hints.nextHint();
+            cout << "Hint: " << hint.text << endl;
+            if(hint.cell != -1) {
+                highlightCell(graph, hint.cell);
+                pause(1000);
+            }
+        } else if(wordList.contains(word)) {
+            log.recordWord(word, WORD_REPEATED);
             cout << "You have already found that word." << endl;
-        } else if(humanWordSearch(board, word)) {
+        } else if(humanWordSearch(graph, word, rule)) {
             cout << "You found a new word! \"" << word << "\"" << endl << endl;
+            log.recordWord(word, WORD_ACCEPTED);
             wordList.add(word);
-            humanScore += getPoints(word);
+            hints.markFound(word);
+            humanScore += rules.score(word);
             gui::setScore("human", humanScore);
             gui::recordWord("human", word);
         } else if (word != ""){
+            log.recordWord(word, WORD_NOT_ON_BOARD);
             cout << "That word can't be formed on this board." << endl;
         }
     }
@@ -199,63 +376,110 @@ Set<string> humanTurn(Grid<char>& board, Lexicon& dictionary, int humanScore) {
     return wordList;
 }
 
-/* This function scans each row and column pair to see if the char mathces the
- * first letter of the user's input word. If a valid row/column pair is found,
- * the word search begins. */
+/* The board is converted to its graph form before the word search begins. */
 bool humanWordSearch(Grid<char>& board, string word) {
-    for(int row = 0; row < BOARD_SIZE; row++) {
-        for(int col = 0; col < BOARD_SIZE; col++) {
-            char start = board[row][col];
-            if(start == word[0]) {
-                if(searchForWord(board, word, charToString(start), row, col)) {
-                    return true;
-                }
+    return humanWordSearch(gridBoardGraph(board), word);
+}
+
+/* This function scans each cell to see if the char matches the first letter of the
+ * user's input word. If a matching cell is found, the word search begins. When cubes may be
+ * reused or the game is anagrams, the path is found directly by the solver and then
+ * highlighted. */
+bool humanWordSearch(const BoardGraph& graph, string word, DiceRule rule) {
+    if(rule != USE_EACH_CUBE_ONCE) {
+        Vector<int> path = findWordPath(graph, word, rule);
+        for(int cell : path) {
+            highlightCell(graph, cell);
+            pause(400);
+        }
+        return !path.isEmpty();
+    }
+    vector<bool> visited(graph.cellCount(), false);
+    for(int cell = 0; cell < graph.cellCount(); cell++) {
+        if(!word.empty() && cellMatches(graph.letters[cell], word[0])) {
+            if(searchForWord(graph, word, visited, cell)) {
+                return true;
             }
         }
     }
     return false;
 }
 
-/* The word search algorithm starts from a position on the board where the char matches
- * the first letter of the user input word. From there, it investigates all adjcaent
- * chars. If the current/adjacent char pair is the prefix for the user's word, the algorithm
- * continues its search. If not, the algorithm terminates that search path. If all paths
- * are explored and the word is not found, the function returns false. */
-bool searchForWord(Grid<char> board, string word, string potentialWord, int row, int col) {
-    gui::setHighlighted(row, col);
-    board[row][col] = integerToChar(0); // ensures letters are used only once
+/* Highlights a cell on the GUI; the cube board is not drawn, so its cells are skipped. */
+void highlightCell(const BoardGraph& graph, int cell) {
+    if(graph.shape != BoardGraph::CUBE) {
+        gui::setHighlighted(graph.row(cell), graph.col(cell));
+    }
+}
+
+/* The word search algorithm starts from a cell whose char matches the first letter of the
+ * user input word. From there, it investigates all adjacent cells. If an unused adjacent
+ * cell holds the next letter of the word, the algorithm continues its search from it. If
+ * not, the algorithm backs up from that search path. If all paths are explored and the word
+ * is not found, the function returns false. The search keeps its own stack: path holds the
+ * cells matched so far, and next the adjacency index of the next neighbor to try from each. */
+bool searchForWord(const BoardGraph& graph, const string& word, vector<bool>& visited, int start) {
+    vector<int> path(1, start);
+    vector<int> next(1, graph.offsets[start]);
+    highlightCell(graph, start);
+    visited[start] = true; // ensures letters are used only once
     pause(400);
-    if(potentialWord == word) {
-        return true;
-    } else {
-        for(int i = -1; i <= 1; i++) {
-            for(int j = -1; j <= 1; j++) {
-                if(inBounds(row + i, col + j)) {
-                    string searchWord = potentialWord + board[row + i][col + j];
-                    if(startsWith(word, searchWord)) {
-                        if(searchForWord(board, word, searchWord, row + i, col + j)) {
-                            return true;
-                        }
-                    }
-                }
+    while(!path.empty()) {
+        int cell = path.back();
+        if(path.size() == word.length()) {
+            for(int used : path) {
+                visited[used] = false;
             }
+            return true;
+        }
+        if(next.back() == graph.offsets[cell + 1]) {
+            visited[cell] = false;
+            gui::clearHighlighting();
+            path.pop_back();
+            next.pop_back();
+            continue;
+        }
+        int candidate = graph.neighbors[next.back()++];
+        if(!visited[candidate] && cellMatches(graph.letters[candidate], word[path.size()])) {
+            highlightCell(graph, candidate);
+            visited[candidate] = true;
+            pause(400);
+            path.push_back(candidate);
+            next.push_back(graph.offsets[candidate]);
         }
     }
-    gui::clearHighlighting();
     return false;
 }
 
 /* The CPU undergoes an exhaustive search of words that can be formed from the board
  * that the user had not found. After the CPU word search is completed, the collection
- * of words it found is displayed to the GUI along with its score. */
-void computerTurn(Grid<char>& board, Lexicon& dictionary, Set<string>& humanWords, int humanScore) {
+ * of words it found is displayed to the GUI along with its score, which is returned. An
+ * easier opponent only claims the words no rarer than its tier. The board was already
+ * solved in full for the hints, so its words are picked out of the solution rather than
+ * found by a second, tier-limited search, which would only add to the game's cost; the
+ * blank cube spellings are looked up by id, so the words kept keep theirs. */
+int computerTurn(Lexicon& dictionary, const GameRules& rules, const Vector<int>& solution,
+                  const Map<int, string>& spellings, Set<string>& humanWords, int humanScore,
+                  WordTier opponent) {
     cout << "It's my turn!" << endl;
+    const DictionaryTrie& trie = compiledDictionary(dictionary);
+    Vector<int> known;
+    for(int id : solution) {
+        if(trie.wordTier(id) <= opponent) {
+            known.add(id);
+        }
+    }
     int computerScore = 0;
-    Set<string> computerWords = computerWordSearch(board, dictionary, humanWords);
+    Map<string, string> wildcardSpellings;
+    Set<string> computerWords = computerWordSearch(dictionary, known, spellings, humanWords,
+                                                   wildcardSpellings);
     cout << "My words: " << computerWords << endl;
+    if(!wildcardSpellings.isEmpty()) {
+        cout << "Blank cubes used (lowercase): " << wildcardSpellings << endl;
+    }
     for(string word : computerWords) {
         gui::recordWord("computer", word);
-        computerScore += getPoints(word);
+        computerScore += rules.score(word);
     }
     gui::setScore("computer", computerScore);
     cout << "My score: " << computerScore << endl;
@@ -267,45 +491,76 @@ void computerTurn(Grid<char>& board, Lexicon& dictionary, Set<string>& humanWord
         cout << "It's a draw. You should play again!" << endl;
     }
     cout << endl;
+    return computerScore;
 }
 
-/* The CPU word search is initiated at each row/column pair. */
+/* The board is converted to its graph form before the CPU word search begins. */
 Set<string> computerWordSearch(Grid<char>& board, Lexicon& dictionary, Set<string>& humanWords) {
+    return computerWordSearch(gridBoardGraph(board), dictionary, humanWords);
+}
+
+/* Searches the board without reporting how its blank cubes were used. */
+Set<string> computerWordSearch(const BoardGraph& graph, Lexicon& dictionary, Set<string>& humanWords,
+                               DiceRule rule) {
+    Map<string, string> wildcardSpellings;
+    return computerWordSearch(graph, dictionary, humanWords, rule, wildcardSpellings);
+}
+
+/* The CPU word search runs the trie-based solver over every cell of the board. The words
+ * the user discovered are not included in the collection returned by this function. Each
+ * returned word that needs a blank cube is mapped in wildcardSpellings to its spelling on
+ * the board, with the letters the blanks stood for in lowercase. */
+Set<string> computerWordSearch(const BoardGraph& graph, Lexicon& dictionary, Set<string>& humanWords,
+                               DiceRule rule, Map<string, string>& wildcardSpellings) {
+    Map<int, string> spellings;
+    Vector<int> solution = solveGameBoard(graph, dictionary, rule, standardRules(), spellings);
+    return computerWordSearch(dictionary, solution, spellings, humanWords, wildcardSpellings);
+}
+
+/* Collects the words of an already solved board that the user did not find. solution and
+ * spellings are the word ids and blank cube spellings reported by solveGameBoard. */
+Set<string> computerWordSearch(Lexicon& dictionary, const Vector<int>& solution,
+                               const Map<int, string>& spellings, Set<string>& humanWords,
+                               Map<string, string>& wildcardSpellings) {
+    const DictionaryTrie& trie = compiledDictionary(dictionary);
     Set<string> words;
-    for(int row = 0; row < BOARD_SIZE; row++) {
-        for(int col = 0; col < BOARD_SIZE; col++) {
-            string start = charToString(board[row][col]);
-            words += exhaustiveSearch(board, dictionary, humanWords, start, row, col);
+    for(int id : solution) {
+        if(!humanWords.contains(trie.word(id))) {
+            words += trie.word(id);
+            if(spellings.containsKey(id)) {
+                wildcardSpellings.put(trie.word(id), spellings.get(id));
+            }
         }
     }
     return words;
 }
 
-/* From a start row/column pair, the CUP investigates all the adjacent chars. If the current/
- * adjacent pair is the prefix of a word in the English dictionary, the search is continued.
- * After a word as been found, the same word is checked to be a prefix for another word. If
- * that is the case, the search continues further. In this way, all possible words are found.
- * The words the user discovered are not included in the collection returned by this function. */
-Set<string> exhaustiveSearch(Grid<char> board, Lexicon& dictionary, Set<string>& humanWords,
-                             string potentialWord, int row, int col) {
-    Set<string> foundWords;
-    board[row][col] = integerToChar(0); // ensures letters are used only once
-    if(dictionary.contains(potentialWord) && potentialWord.length() >= MIN_WORD_LENGTH &&
-             !humanWords.contains(potentialWord)) {
-        foundWords += potentialWord;
-    }
-    if (dictionary.containsPrefix(potentialWord)) {
-        for(int i = -1; i <= 1; i++) {
-            for(int j = -1; j <= 1; j++) {
-                if(inBounds(row + i, col + j) && board[row + i][col + j] != integerToChar(0)) {
-                    string searchWord = potentialWord + board[row + i][col + j];
-                    if(dictionary.containsPrefix(searchWord)) {
-                        foundWords += exhaustiveSearch(board, dictionary, humanWords,
-                                                      searchWord, row + i, col + j);
-                    }
-                }
-            }
-        }
+/* Solves the board once for the whole game; the hints and the CPU's turn both work from the
+ * result, so the search is never limited to an easier opponent's tier. Boards bigger than
+ * the largest flat board are searched on every core. */
+Vector<int> solveGameBoard(const BoardGraph& graph, Lexicon& dictionary, DiceRule rule,
+                           const GameRules& rules, Map<int, string>& spellings) {
+    SolveOptions options;
+    options.rule = rule;
+    if(graph.cellCount() > THREADED_BOARD_CELLS) {
+        options.threads = max(1, (int) thread::hardware_concurrency());
+    }
+    return solveWithRules(graph, compiledDictionary(dictionary), rules, options, spellings);
+}
+
+/* The dictionary is compiled into a trie the first time the CPU searches it, and the trie is
+ * reused by every later search of the same dictionary. Its words are sorted into tiers by the
+ * frequency list, if there is one. */
+const DictionaryTrie& compiledDictionary(Lexicon& dictionary) {
+    static Lexicon* compiledFrom = nullptr;
+    static int compiledSize = 0;
+    static DictionaryTrie* trie = nullptr;
+    if(compiledFrom != &dictionary || compiledSize != dictionary.size()) {
+        delete trie;
+        trie = new DictionaryTrie(dictionary);
+        loadWordTiers(*trie);
+        compiledFrom = &dictionary;
+        compiledSize = dictionary.size();
     }
-    return foundWords;
+    return *trie;
 }
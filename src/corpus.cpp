@@ -0,0 +1,123 @@
+/* CORPUS
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * Reads corpus files and solves their boards in parallel. The boards are solved a block at a
+ * time so that memory use does not grow with the size of the corpus. */
+
+#include "corpus.h"
+#include <cmath>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include "error.h"
+#include "grid.h"
+#include "map.h"
+#include "strlib.h"
+using namespace std;
+
+/* Number of boards solved before their results are handed to the caller. */
+const int CORPUS_BLOCK_SIZE = 4096;
+
+/*************************************************
+ *             PROTOTYPE FUNCTIONS               *
+ ************************************************/
+void solveCorpusBlock(const vector<BoardGraph>& graphs, const DictionaryTrie& trie,
+                      const SolveOptions& options, int first, int step, vector<Vector<int>>& results,
+                      vector<Vector<int>>& pathCounts);
+
+
+/*************************************************
+ *                  FUNCTIONS                    *
+ ************************************************/
+
+Vector<string> readCorpus(const string& filename) {
+    ifstream input(filename.c_str());
+    if(!input) {
+        error("readCorpus: cannot open " + filename);
+    }
+    Vector<string> boards;
+    string line;
+    while(getline(input, line)) {
+        line = trim(line);
+        if(!line.empty() && line[0] != '#') {
+            boards.add(toUpperCase(line));
+        }
+    }
+    return boards;
+}
+
+BoardGraph corpusBoardGraph(const string& letters) {
+    int size = (int) round(sqrt((double) letters.length()));
+    if(size == 0 || size * size != (int) letters.length()) {
+        error("corpusBoardGraph: \"" + letters + "\" is not a square board");
+    }
+    Grid<char> board(size, size);
+    for(int i = 0; i < (int) letters.length(); i++) {
+        board[i / size][i % size] = letters[i];
+    }
+    return gridBoardGraph(board);
+}
+
+void appendToCorpus(const string& filename, const Vector<string>& boards, const string& comment) {
+    ofstream output(filename.c_str(), ios::app);
+    if(!output) {
+        error("appendToCorpus: cannot open " + filename);
+    }
+    if(!comment.empty()) {
+        output << "# " << comment << endl;
+    }
+    for(const string& board : boards) {
+        output << board << endl;
+    }
+    if(!output) {
+        error("appendToCorpus: cannot write " + filename);
+    }
+}
+
+/* The graphs of a block are built up front on the calling thread, which keeps the workers
+ * off the topology cache's lock and reports a malformed board before any work starts. The
+ * block is then split between the threads by board index, and its results are handed over in
+ * order once every thread has finished. */
+void solveCorpus(const Vector<string>& boards, const DictionaryTrie& trie, const SolveOptions& options,
+                 int threads, const function<void(int board, const Vector<int>& wordIds,
+                                                  const Vector<int>& pathCounts)>& visit) {
+    threads = max(1, threads);
+    vector<BoardGraph> graphs;
+    vector<Vector<int>> results;
+    vector<Vector<int>> pathCounts;
+    for(int first = 0; first < boards.size(); first += CORPUS_BLOCK_SIZE) {
+        int count = min(CORPUS_BLOCK_SIZE, boards.size() - first);
+        graphs.clear();
+        for(int i = first; i < first + count; i++) {
+            graphs.push_back(corpusBoardGraph(boards[i]));
+        }
+        results.assign(count, Vector<int>());
+        pathCounts.assign(count, Vector<int>());
+        if(threads == 1 || count == 1) {
+            solveCorpusBlock(graphs, trie, options, 0, 1, results, pathCounts);
+        } else {
+            vector<thread> workers;
+            for(int i = 0; i < min(threads, count); i++) {
+                workers.push_back(thread(solveCorpusBlock, cref(graphs), cref(trie), cref(options),
+                                         i, threads, ref(results), ref(pathCounts)));
+            }
+            for(thread& worker : workers) {
+                worker.join();
+            }
+        }
+        for(int i = 0; i < count; i++) {
+            visit(first + i, results[i], pathCounts[i]);
+        }
+    }
+}
+
+/* Solves every step-th board of the block, starting with the board at index first. */
+void solveCorpusBlock(const vector<BoardGraph>& graphs, const DictionaryTrie& trie,
+                      const SolveOptions& options, int first, int step, vector<Vector<int>>& results,
+                      vector<Vector<int>>& pathCounts) {
+    for(int i = first; i < (int) graphs.size(); i += step) {
+        Map<int, string> wildcardSpellings;
+        results[i] = solveBoard(graphs[i], trie, options, wildcardSpellings, pathCounts[i]);
+    }
+}
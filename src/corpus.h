@@ -0,0 +1,44 @@
+/* CORPUS
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * A corpus is a text file of boards, one per line, used for batch work such as indexing and
+ * rating puzzles. Each line holds the letters of one square board in row-major order, so a
+ * 4x4 board is a line of 16 letters; blank lines and lines starting with '#' are ignored.
+ * Boards are numbered from 0 in the order they appear, and that number is the board's id in
+ * everything built from the corpus. */
+
+#ifndef _corpus_h
+#define _corpus_h
+
+#include <functional>
+#include <string>
+#include "boardgraph.h"
+#include "dictionarytrie.h"
+#include "vector.h"
+#include "wordsolver.h"
+
+/* Returns the boards of the given corpus file, one string of letters per board. Throws an
+ * ErrorException if the file cannot be opened. */
+Vector<std::string> readCorpus(const std::string& filename);
+
+/* Returns the graph of a square board given as a corpus line. Throws an ErrorException if the
+ * number of letters is not a perfect square. */
+BoardGraph corpusBoardGraph(const std::string& letters);
+
+/* Appends the boards to the corpus file, one per line, creating the file if it does not exist.
+ * A non-empty comment is written first as a '#' line. Throws an ErrorException if the file
+ * cannot be written. */
+void appendToCorpus(const std::string& filename, const Vector<std::string>& boards,
+                    const std::string& comment = "");
+
+/* Solves every board of the corpus with the given options, spreading the boards across the
+ * given number of threads, and calls visit with each board's id, found word ids, and path
+ * counts (empty unless options.countPaths is set). The calls are made from the calling thread
+ * in increasing board order. */
+void solveCorpus(const Vector<std::string>& boards, const DictionaryTrie& trie,
+                 const SolveOptions& options, int threads,
+                 const std::function<void(int board, const Vector<int>& wordIds,
+                                          const Vector<int>& pathCounts)>& visit);
+
+#endif // _corpus_h
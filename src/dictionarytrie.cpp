@@ -0,0 +1,191 @@
+/* DICTIONARY TRIE
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * Compiles a sorted word list into the array-based trie declared in dictionarytrie.h. Because
+ * the words are sorted, the words below any node form one contiguous range of the list, and
+ * a node's children are found by splitting its range on the next letter. */
+
+#include "dictionarytrie.h"
+#include <algorithm>
+#include "error.h"
+#include "strlib.h"
+using namespace std;
+
+/*************************************************
+ *             PROTOTYPE FUNCTIONS               *
+ ************************************************/
+bool isAlphabetic(const string& word);
+PackedLetterCounts packLetterCounts(const string& word);
+
+
+/*************************************************
+ *                  FUNCTIONS                    *
+ ************************************************/
+
+DictionaryTrie::DictionaryTrie(const Lexicon& lexicon) : tiered(false) {
+    Vector<string> list;
+    for(string word : lexicon) {
+        list.add(word);
+    }
+    build(list);
+}
+
+DictionaryTrie::DictionaryTrie(const Vector<string>& words) : tiered(false) {
+    build(words);
+}
+
+int DictionaryTrie::find(const string& prefix) const {
+    int node = ROOT;
+    for(int i = 0; i < (int) prefix.length() && node != NONE; i++) {
+        int letter = letterIndex(prefix[i]);
+        node = letter == -1 ? NONE : child(node, letter);
+    }
+    return node;
+}
+
+bool DictionaryTrie::contains(const string& word) const {
+    int node = find(toUpperCase(word));
+    return node != NONE && wordId(node) != NONE;
+}
+
+/* Short words are stored inside their std::string; only longer ones have a heap block. */
+size_t DictionaryTrie::memoryBytes() const {
+    size_t bytes = nodes.capacity() * sizeof(Node) + packedCounts.capacity() * sizeof(PackedLetterCounts) +
+                   words.capacity() * sizeof(string) + tiers.capacity() + subtreeTiers.capacity();
+    for(const string& word : words) {
+        const char* inside = reinterpret_cast<const char*>(&word);
+        if(word.data() < inside || word.data() >= inside + sizeof(string)) {
+            bytes += word.capacity() + 1;
+        }
+    }
+    return bytes;
+}
+
+/* A node's children always come after it in the node array, so walking the array backwards
+ * reaches every node after all of its children. */
+void DictionaryTrie::setWordTiers(const vector<unsigned char>& wordTiers) {
+    if((int) wordTiers.size() != wordCount()) {
+        error("DictionaryTrie: expected " + integerToString(wordCount()) + " word tiers, got " +
+              integerToString(wordTiers.size()));
+    }
+    tiers = wordTiers;
+    for(int node = nodeCount() - 1; node >= 0; node--) {
+        int best = nodes[node].wordId == NONE ? (int) RARE_WORD : tiers[nodes[node].wordId];
+        for(int i = 0; i < __builtin_popcount(nodes[node].childMask); i++) {
+            best = min(best, (int) subtreeTiers[nodes[node].firstChild + i]);
+        }
+        subtreeTiers[node] = best;
+    }
+    tiered = true;
+}
+
+/* The words are uppercased, filtered to A-Z, sorted, and numbered, and then the trie is
+ * built top-down from the root's range, which is the whole list. The node array is copied
+ * once it is complete, so that it occupies as few huge pages as possible instead of the
+ * capacity left over from growing it. */
+void DictionaryTrie::build(Vector<string> list) {
+    words.clear();
+    nodes.clear();
+    for(string word : list) {
+        word = toUpperCase(word);
+        if(!word.empty() && isAlphabetic(word)) {
+            words.push_back(word);
+        }
+    }
+    sort(words.begin(), words.end());
+    words.erase(unique(words.begin(), words.end()), words.end());
+    nodes.push_back(Node {0, 0, NONE});
+    buildChildren(ROOT, 0, words.size(), 0);
+    HugePageVector<Node>(nodes).swap(nodes);
+    packedCounts.clear();
+    packedCounts.reserve(words.size());
+    for(const string& word : words) {
+        packedCounts.push_back(packLetterCounts(word));
+    }
+    tiers.assign(words.size(), COMMON_WORD);
+    subtreeTiers.assign(nodes.size(), COMMON_WORD);
+    tiered = false;
+    checksum = 2166136261u;   // 32-bit FNV-1a over the words, each followed by a newline
+    for(const string& word : words) {
+        for(char ch : word + "\n") {
+            checksum = (checksum ^ (unsigned char) ch) * 16777619u;
+        }
+    }
+}
+
+/* words[low, high) are exactly the words passing through node, which is at the given depth.
+ * The first of them ends at the node if it is depth letters long. The rest are split into
+ * runs sharing the same next letter; each run becomes one child, and all of the children are
+ * allocated together before recursing so that they stay adjacent in the node array. */
+void DictionaryTrie::buildChildren(int node, int low, int high, int depth) {
+    if(low < high && (int) words[low].length() == depth) {
+        nodes[node].wordId = low;
+        low++;
+    }
+    Vector<int> runStarts;
+    for(int i = low; i < high; i++) {
+        if(i == low || words[i][depth] != words[i - 1][depth]) {
+            runStarts.add(i);
+            nodes[node].childMask |= uint32_t(1) << letterIndex(words[i][depth]);
+        }
+    }
+    runStarts.add(high);
+    int firstChild = nodes.size();
+    nodes[node].firstChild = firstChild;
+    for(int i = 0; i + 1 < runStarts.size(); i++) {
+        nodes.push_back(Node {0, 0, NONE});
+    }
+    for(int i = 0; i + 1 < runStarts.size(); i++) {
+        buildChildren(firstChild + i, runStarts[i], runStarts[i + 1], depth + 1);
+    }
+}
+
+DictionaryDiff diffDictionaries(const DictionaryTrie& from, const DictionaryTrie& to) {
+    DictionaryDiff diff;
+    int next = 0;
+    for(int id = 0; id < from.wordCount(); id++) {
+        while(next < to.wordCount() && to.word(next) < from.word(id)) {
+            diff.added.add(next++);
+        }
+        if(next < to.wordCount() && to.word(next) == from.word(id)) {
+            diff.newIds.add(next++);
+        } else {
+            diff.newIds.add((int) DictionaryTrie::NONE);
+            diff.removed.add(id);
+        }
+    }
+    while(next < to.wordCount()) {
+        diff.added.add(next++);
+    }
+    return diff;
+}
+
+/* Packs the counts of an uppercase word's letters as described in dictionarytrie.h. Lengths
+ * above 255 are stored as 255. */
+PackedLetterCounts packLetterCounts(const string& word) {
+    int counts[ALPHABET_SIZE] = {0};
+    for(char ch : word) {
+        counts[letterIndex(ch)]++;
+    }
+    PackedLetterCounts packed = {0, 0};
+    for(int letter = 0; letter < ALPHABET_SIZE; letter++) {
+        uint64_t& half = letter < 16 ? packed.low : packed.high;
+        half |= uint64_t(min(counts[letter], 7)) << (4 * (letter % 16));
+        if(counts[letter] > 7) {
+            packed.high |= PackedLetterCounts::CAPPED;
+        }
+    }
+    packed.high |= uint64_t(min((int) word.length(), 255)) << PackedLetterCounts::LENGTH_SHIFT;
+    return packed;
+}
+
+/* Returns true if every char of the word is an uppercase letter. */
+bool isAlphabetic(const string& word) {
+    for(char ch : word) {
+        if(letterIndex(ch) == -1) {
+            return false;
+        }
+    }
+    return true;
+}
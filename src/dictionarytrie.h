@@ -0,0 +1,259 @@
+/* DICTIONARY TRIE
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * A compiled, read-only form of the dictionary used by the CPU word search. Every word is
+ * given an id (its position in sorted order), and the words are stored in a trie whose nodes
+ * sit in one array. The children of a node are stored next to each other in letter order,
+ * so a node only needs a 26-bit mask of the letters it has children for and the index of its
+ * first child: the child for a letter is found by counting the mask bits below that letter.
+ * Unlike a Lexicon, the search can walk this trie one letter at a time instead of rechecking
+ * the whole prefix string at every step. Each word's letter counts are also kept packed into
+ * two machine words, so that whole words can be checked against a bag of letters at once.
+ * Both arrays are allocated on huge pages where the system provides them (see hugepages.h).
+ *
+ * Every word can also be given a tier, from common to rare, and every node records the most
+ * common tier of the words below it. A TierLimitedTrie uses those to hide the rarer words
+ * from the search, for computer opponents that should not know the whole dictionary. */
+
+#ifndef _dictionarytrie_h
+#define _dictionarytrie_h
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "hugepages.h"
+#include "lexicon.h"
+#include "vector.h"
+
+/* Number of letters a trie node can branch on; cells and words are restricted to A-Z. */
+const int ALPHABET_SIZE = 26;
+
+/* Returns the trie letter index (0-25) of an uppercase letter, or -1 for any other char. */
+inline int letterIndex(char ch) {
+    return ch >= 'A' && ch <= 'Z' ? ch - 'A' : -1;
+}
+
+/* How common a word is, from the words nearly every player knows to the ones a frequency list
+ * does not include at all. See loadWordTiers in difficulty.h. */
+enum WordTier {
+    COMMON_WORD,
+    FAMILIAR_WORD,
+    UNCOMMON_WORD,
+    RARE_WORD
+};
+
+/* A word's letter counts, four bits per letter: A-P in low, and Q-Z in the low 40 bits of high.
+ * Each count sits in the low three bits of its field, so that subtracting from a bag whose
+ * fields have their top bit set leaves that bit set exactly where the bag has enough of the
+ * letter. Counts above 7 are stored as 7 and flagged. The top byte of high holds the length. */
+struct PackedLetterCounts {
+    uint64_t low;
+    uint64_t high;
+
+    static const int LENGTH_SHIFT = 56;
+    static const uint64_t CAPPED = uint64_t(1) << 55;
+
+    int length() const {
+        return high >> LENGTH_SHIFT;
+    }
+
+    /* Returns true if some letter occurs more than 7 times, so that the counts are a lower
+     * bound. */
+    bool capped() const {
+        return (high & CAPPED) != 0;
+    }
+};
+
+class DictionaryTrie {
+public:
+    /* Index of the node for the empty prefix. */
+    static const int ROOT = 0;
+
+    /* Returned by child() when there is no edge and by wordId() for non-word nodes. */
+    static const int NONE = -1;
+
+    /* Compiles every word of the lexicon made only of the letters A-Z. */
+    DictionaryTrie(const Lexicon& lexicon);
+
+    /* Compiles the given words; case is ignored and duplicates are removed. */
+    DictionaryTrie(const Vector<std::string>& words);
+
+    /* Returns the node reached from node by the given letter index, or NONE. */
+    int child(int node, int letter) const {
+        uint32_t bit = uint32_t(1) << letter;
+        if((nodes[node].childMask & bit) == 0) {
+            return NONE;
+        }
+        return nodes[node].firstChild + __builtin_popcount(nodes[node].childMask & (bit - 1));
+    }
+
+    /* Returns a mask with bit i set if node has a child for letter index i. */
+    uint32_t childMask(int node) const {
+        return nodes[node].childMask;
+    }
+
+    /* Returns the id of the word spelled by the path to node, or NONE. */
+    int wordId(int node) const {
+        return nodes[node].wordId;
+    }
+
+    /* Starts loading node into the cache without waiting for it, so that the fetch overlaps
+     * with whatever the search does before it reaches the node. */
+    void prefetch(int node) const {
+        __builtin_prefetch(&nodes[node]);
+    }
+
+    /* Starts loading the first children of node; node itself should already be cached or on
+     * its way, since it is read to find them. A leaf has no children to load, and its
+     * firstChild may lie past the end of the nodes. */
+    void prefetchChildren(int node) const {
+        if(nodes[node].childMask != 0) {
+            __builtin_prefetch(&nodes[nodes[node].firstChild]);
+        }
+    }
+
+    /* Returns the node for the given prefix, or NONE if no word starts with it. */
+    int find(const std::string& prefix) const;
+
+    /* Returns true if the given word is in the dictionary. */
+    bool contains(const std::string& word) const;
+
+    /* Returns the uppercase word with the given id. */
+    const std::string& word(int id) const {
+        return words[id];
+    }
+
+    int nodeCount() const {
+        return nodes.size();
+    }
+
+    int wordCount() const {
+        return words.size();
+    }
+
+    /* Sets the tier of every word id, indexed by id, and works out each node's subtreeTier.
+     * Until it is called every word is a COMMON_WORD. */
+    void setWordTiers(const std::vector<unsigned char>& wordTiers);
+
+    /* Returns true if setWordTiers has been called. */
+    bool hasWordTiers() const {
+        return tiered;
+    }
+
+    WordTier wordTier(int id) const {
+        return WordTier(tiers[id]);
+    }
+
+    /* Returns the most common tier of the words at or below node. */
+    WordTier subtreeTier(int node) const {
+        return WordTier(subtreeTiers[node]);
+    }
+
+    /* Returns the packed letter counts of the word with the given id. */
+    const PackedLetterCounts& letterCounts(int id) const {
+        return packedCounts[id];
+    }
+
+    /* Returns the bytes used by the nodes, the words, and their letter counts. */
+    size_t memoryBytes() const;
+
+    /* Returns a checksum of the word list. Files that store word ids record it so that they
+     * are not read back against a different dictionary. */
+    uint32_t fingerprint() const {
+        return checksum;
+    }
+
+private:
+    struct Node {
+        uint32_t childMask;   // letters this node has children for
+        int firstChild;       // index of the child for the lowest letter in childMask
+        int wordId;           // id of the word ending here, or NONE
+    };
+
+    void build(Vector<std::string> words);
+    void buildChildren(int node, int low, int high, int depth);
+
+    // The node and word arrays are read on every step of the search, so neither is kept in a
+    // Vector, whose bounds checking would cost on each read. The nodes and letter counts are
+    // read at random across megabytes, so they are kept in HugePageVectors to spare TLB misses;
+    // the words and tiers are plain std::vectors.
+    HugePageVector<Node> nodes;
+    std::vector<std::string> words;
+    HugePageVector<PackedLetterCounts> packedCounts;
+    std::vector<unsigned char> tiers;            // tier of each word id
+    HugePageVector<unsigned char> subtreeTiers;  // most common tier at or below each node
+    bool tiered;
+    uint32_t checksum;
+};
+
+/* The words gained and lost between two versions of a dictionary. */
+struct DictionaryDiff {
+    Vector<int> removed;   // ids in the old dictionary of the words the new one lacks
+    Vector<int> added;     // ids in the new dictionary of the words the old one lacks
+    Vector<int> newIds;    // id in the new dictionary of each old word, or NONE if it was removed
+};
+
+/* Compares the word lists of the old and new dictionaries. Both are sorted by id, so they are
+ * merged in one pass. */
+DictionaryDiff diffDictionaries(const DictionaryTrie& from, const DictionaryTrie& to);
+
+/* A view of a DictionaryTrie without the words rarer than a given tier. It offers the edge
+ * operations the solver takes from a trie, so the same search runs on it: child returns NONE
+ * for a child below which every word is too rare, so that subtree is never entered, and
+ * wordId hides the too rare words met on the way. A search limited to common words thus only
+ * walks the part of the trie that spells them. childMask still reports every child, as the
+ * solver allows (see wordsolver.h); the subtree tiers take a byte per node, so they mostly
+ * stay cached while the search reads them. */
+class TierLimitedTrie {
+public:
+    static const int ROOT = DictionaryTrie::ROOT;
+    static const int NONE = DictionaryTrie::NONE;
+
+    TierLimitedTrie(const DictionaryTrie& trie, WordTier rarest) : trie(trie), rarest(rarest) {}
+
+    int child(int node, int letter) const {
+        int next = trie.child(node, letter);
+        return next != NONE && trie.subtreeTier(next) <= rarest ? next : NONE;
+    }
+
+    uint32_t childMask(int node) const {
+        return trie.childMask(node);
+    }
+
+    int wordId(int node) const {
+        int id = trie.wordId(node);
+        return id != NONE && trie.wordTier(id) <= rarest ? id : NONE;
+    }
+
+    void prefetch(int node) const {
+        trie.prefetch(node);
+    }
+
+    void prefetchChildren(int node) const {
+        trie.prefetchChildren(node);
+    }
+
+    const std::string& word(int id) const {
+        return trie.word(id);
+    }
+
+    int wordCount() const {
+        return trie.wordCount();
+    }
+
+    /* Returns the whole trie the view was made from. */
+    const DictionaryTrie& dictionary() const {
+        return trie;
+    }
+
+    WordTier rarestTier() const {
+        return rarest;
+    }
+
+private:
+    const DictionaryTrie& trie;
+    WordTier rarest;
+};
+
+#endif // _dictionarytrie_h
@@ -0,0 +1,177 @@
+/* DIFFICULTY
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * Implements DifficultyRater. The weights below were chosen so that typical random 4x4 boards
+ * land in the middle of the scale; a component that cannot be measured (commonness, with no
+ * frequency list) is left out and the remaining weights are scaled up to compensate. */
+
+#include "difficulty.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include "map.h"
+#include "strlib.h"
+using namespace std;
+
+/* A board with this many words or more is as plentiful as boards get. */
+const int PLENTIFUL_WORD_COUNT = 400;
+
+/* Words worth at least this many points count as long words. */
+const int LONG_WORD_POINTS = 3;
+
+/* Shares of the listed words in the common tier, and in the common and familiar tiers. */
+const double COMMON_WORD_SHARE = 0.2;
+const double FAMILIAR_WORD_SHARE = 0.5;
+
+const double SCARCITY_WEIGHT = 0.30;
+const double LONG_WORD_WEIGHT = 0.15;
+const double PATH_SCARCITY_WEIGHT = 0.20;
+const double OBSCURITY_WEIGHT = 0.20;
+const double LONGEST_RARITY_WEIGHT = 0.15;
+
+/*************************************************
+ *             PROTOTYPE FUNCTIONS               *
+ ************************************************/
+vector<float> readFrequencies(const DictionaryTrie& trie, const string& filename);
+
+
+/*************************************************
+ *                  FUNCTIONS                    *
+ ************************************************/
+
+DifficultyRater::DifficultyRater(const DictionaryTrie& trie, const string& frequencyFile,
+                                 const GameRules& rules) : trie(trie) {
+    for(int id = 0; id < trie.wordCount(); id++) {
+        lengths.push_back(min(rules.length(trie.word(id)), 255));
+        points.push_back(min(rules.score(trie.word(id)), 255));
+    }
+    commonness = readFrequencies(trie, frequencyFile);
+}
+
+DifficultyRating DifficultyRater::rate(const BoardGraph& graph, SolveOptions options) const {
+    options.countPaths = true;
+    Map<int, string> wildcardSpellings;
+    Vector<int> pathCounts;
+    Vector<int> wordIds = solveBoard(graph, trie, options, wildcardSpellings, pathCounts);
+    return rate(wordIds, pathCounts);
+}
+
+/* One pass over the words gathers the totals each component needs. Of several longest words,
+ * the first in id order is kept. */
+DifficultyRating DifficultyRater::rate(const Vector<int>& wordIds, const Vector<int>& pathCounts) const {
+    DifficultyRating rating = {wordIds.size(), 0, 0, 0, -1, -1, 100};
+    if(wordIds.isEmpty()) {
+        return rating;
+    }
+    int longPoints = 0;
+    double inversePaths = 0;
+    double totalCommonness = 0;
+    long totalPaths = 0;
+    for(int i = 0; i < wordIds.size(); i++) {
+        int id = wordIds[i];
+        int paths = i < pathCounts.size() ? max(1, pathCounts[i]) : 1;
+        rating.totalPoints += points[id];
+        longPoints += points[id] >= LONG_WORD_POINTS ? points[id] : 0;
+        totalPaths += paths;
+        inversePaths += 1.0 / paths;
+        rating.singlePathWords += paths == 1;
+        if(hasFrequencies()) {
+            totalCommonness += commonness[id];
+        }
+        int longest = rating.longestWord;
+        if(longest == -1 || lengths[id] > lengths[longest]) {
+            rating.longestWord = id;
+        }
+    }
+    int words = wordIds.size();
+    rating.meanPathCount = double(totalPaths) / words;
+    double scarcity = 1 - min(1.0, log(1.0 + words) / log(1.0 + PLENTIFUL_WORD_COUNT));
+    double longWordShare = rating.totalPoints == 0 ? 0 : double(longPoints) / rating.totalPoints;
+    double pathScarcity = inversePaths / words;
+    double weighted = SCARCITY_WEIGHT * scarcity + LONG_WORD_WEIGHT * longWordShare +
+                      PATH_SCARCITY_WEIGHT * pathScarcity;
+    double weights = SCARCITY_WEIGHT + LONG_WORD_WEIGHT + PATH_SCARCITY_WEIGHT + LONGEST_RARITY_WEIGHT;
+    if(hasFrequencies()) {
+        rating.meanCommonness = totalCommonness / words;
+        weighted += OBSCURITY_WEIGHT * (1 - rating.meanCommonness);
+        weighted += LONGEST_RARITY_WEIGHT * (1 - commonness[rating.longestWord]);
+        weights += OBSCURITY_WEIGHT;
+    } else {
+        int longestIndex = find(wordIds.begin(), wordIds.end(), rating.longestWord) - wordIds.begin();
+        int longestPaths = longestIndex < pathCounts.size() ? max(1, pathCounts[longestIndex]) : 1;
+        weighted += LONGEST_RARITY_WEIGHT / longestPaths;
+    }
+    rating.difficulty = 100 * weighted / weights;
+    return rating;
+}
+
+/* A word counts as listed if its commonness is above 0, which leaves out listed words with a
+ * count of 0. Words equally common keep their id order. */
+bool loadWordTiers(DictionaryTrie& trie, const string& frequencyFile) {
+    vector<float> commonness = readFrequencies(trie, frequencyFile);
+    if(commonness.empty()) {
+        return false;
+    }
+    vector<int> listed;
+    for(int id = 0; id < trie.wordCount(); id++) {
+        if(commonness[id] > 0) {
+            listed.push_back(id);
+        }
+    }
+    stable_sort(listed.begin(), listed.end(), [&commonness](int a, int b) {
+        return commonness[a] > commonness[b];
+    });
+    vector<unsigned char> tiers(trie.wordCount(), RARE_WORD);
+    for(int i = 0; i < (int) listed.size(); i++) {
+        double share = double(i) / listed.size();
+        tiers[listed[i]] = share < COMMON_WORD_SHARE ? COMMON_WORD
+                         : share < FAMILIAR_WORD_SHARE ? FAMILIAR_WORD : UNCOMMON_WORD;
+    }
+    trie.setWordTiers(tiers);
+    return true;
+}
+
+/* Returns the commonness of every word id on a log scale, or an empty table if the file does
+ * not exist. With counts, a word's commonness is log(1 + count) / log(1 + highest count);
+ * without, it is 1 - log(1 + rank) / log(1 + number of lines). Unlisted words get 0. */
+vector<float> readFrequencies(const DictionaryTrie& trie, const string& filename) {
+    ifstream input(filename.c_str());
+    if(!input) {
+        return vector<float>();
+    }
+    Vector<int> ids;
+    Vector<double> counts;
+    bool hasCounts = true;
+    string line;
+    while(getline(input, line)) {
+        istringstream fields(line);
+        string word;
+        double count;
+        if(!(fields >> word)) {
+            continue;
+        }
+        if(!(fields >> count)) {
+            hasCounts = false;
+            count = 0;
+        }
+        int node = trie.find(toUpperCase(word));
+        ids.add(node == DictionaryTrie::NONE ? DictionaryTrie::NONE : trie.wordId(node));
+        counts.add(count);
+    }
+    vector<float> commonness(trie.wordCount(), 0);
+    double highest = 0;
+    for(double count : counts) {
+        highest = max(highest, count);
+    }
+    for(int rank = 0; rank < ids.size(); rank++) {
+        if(ids[rank] == DictionaryTrie::NONE) {
+            continue;
+        }
+        double value = hasCounts ? log(1 + counts[rank]) / log(1 + max(highest, 1.0))
+                                 : 1 - log(1.0 + rank) / log(1.0 + ids.size());
+        commonness[ids[rank]] = max(commonness[ids[rank]], (float) value);
+    }
+    return commonness;
+}
@@ -0,0 +1,74 @@
+/* DIFFICULTY
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * Rates how hard a board is for a human player, on a scale from 0 (easy) to 100 (hard). The
+ * rating combines several signs of a hard board, each scaled to lie between 0 and 1:
+ *   - scarcity: few words can be formed at all;
+ *   - long word share: most of the available points are in long words;
+ *   - path scarcity: words can only be traced along one or two paths, which are easy to miss;
+ *   - obscurity: the words are uncommon, according to the optional frequency list;
+ *   - longest word rarity: the board's showpiece word is obscure, or hard to trace when there
+ *     is no frequency list.
+ * Everything the rating needs about a word (its points and commonness) is looked up by word
+ * id in tables built once, so rating a board costs one pass over the solver's output and
+ * whole corpora can be rated at solver speed. */
+
+#ifndef _difficulty_h
+#define _difficulty_h
+
+#include <string>
+#include <vector>
+#include "boardgraph.h"
+#include "dictionarytrie.h"
+#include "gamerules.h"
+#include "vector.h"
+#include "wordsolver.h"
+
+/* Optional word frequency list, kept next to the dictionary. Each line holds a word, optionally
+ * followed by how often it occurs; without counts, the lines are taken to be ordered from the
+ * most to the least common word. */
+const std::string FREQUENCY_FILE = "frequency.txt";
+
+/* Sorts the dictionary's words into tiers by the frequency list, if the file exists: of the
+ * listed words, the most common fifth are COMMON_WORD, the next three tenths FAMILIAR_WORD,
+ * and the rest UNCOMMON_WORD, while unlisted words are RARE_WORD. Returns false, leaving the
+ * trie as it was, if there is no list. */
+bool loadWordTiers(DictionaryTrie& trie, const std::string& frequencyFile = FREQUENCY_FILE);
+
+struct DifficultyRating {
+    int wordCount;
+    int totalPoints;
+    double meanPathCount;     // mean number of paths per word
+    int singlePathWords;      // words with exactly one path
+    double meanCommonness;    // 0 (unlisted) to 1 (most common word), or -1 with no frequency list
+    int longestWord;          // id of the longest word, or -1
+    double difficulty;        // 0 (easy) to 100 (hard)
+};
+
+class DifficultyRater {
+public:
+    /* Prepares to rate boards solved with the given dictionary, scoring words by the given
+     * rules. The frequency list is read if the file exists; otherwise the ratings leave out
+     * commonness. */
+    DifficultyRater(const DictionaryTrie& trie, const std::string& frequencyFile = FREQUENCY_FILE,
+                    const GameRules& rules = standardRules());
+
+    bool hasFrequencies() const {
+        return !commonness.empty();
+    }
+
+    /* Rates a solved board from the word ids and path counts reported by solveBoard. */
+    DifficultyRating rate(const Vector<int>& wordIds, const Vector<int>& pathCounts) const;
+
+    /* Solves the board with the given options, counting paths, and rates it. */
+    DifficultyRating rate(const BoardGraph& graph, SolveOptions options = SolveOptions()) const;
+
+private:
+    const DictionaryTrie& trie;
+    std::vector<unsigned char> lengths;    // length of each word id
+    std::vector<unsigned char> points;     // points for each word id
+    std::vector<float> commonness;         // commonness of each word id; empty with no list
+};
+
+#endif // _difficulty_h
@@ -0,0 +1,416 @@
+/* GAME LOG
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * Writes, reads, and replays game logs. The layout is:
+ *     char[8]   magic "BOGGLELG"
+ *     uint32    format version, in native byte order
+ *     ...       records, each a type byte, the payload length, and the payload
+ *
+ * Lengths and numbers in the payloads are unsigned LEB128 varints. The payloads are:
+ *     GAME      start time, dictionary fingerprint, dice rule, the rules (name, min length,
+ *               max length, Qu rule, point count, points), shape, rows, cols, letters
+ *     WORD      milliseconds since the last event, verdict, word
+ *     SOLUTION  milliseconds since the last event, id count, the first id and the gaps after it,
+ *               for every word on the board
+ *     END       milliseconds since the last event, human score, computer score
+ *
+ * Strings are a varint length followed by their bytes. Each record is assembled in memory and
+ * written with a single call, so a crash leaves at most one partial record at the end of the
+ * file, which the reader treats as the end of the log. Records of an unknown type are skipped,
+ * so a later version can add events that this one ignores. */
+
+#include "gamelog.h"
+#include <chrono>
+#include <cstring>
+#include "error.h"
+#include "grid.h"
+#include "mappedfile.h"
+#include "set.h"
+#include "strlib.h"
+using namespace std;
+
+const char LOG_MAGIC[8] = {'B', 'O', 'G', 'G', 'L', 'E', 'L', 'G'};
+const uint32_t LOG_VERSION = 1;
+const size_t LOG_HEADER_SIZE = sizeof(LOG_MAGIC) + sizeof(uint32_t);
+
+/* Record types. */
+const uint8_t GAME_RECORD = 1;
+const uint8_t WORD_RECORD = 2;
+const uint8_t SOLUTION_RECORD = 3;
+const uint8_t END_RECORD = 4;
+
+/*************************************************
+ *             PROTOTYPE FUNCTIONS               *
+ ************************************************/
+int64_t currentTimeMillis();
+void appendVarint(string& bytes, uint64_t value);
+void appendLogString(string& bytes, const string& text);
+uint64_t readVarint(const char*& bytes, const char* end);
+string readLogString(const char*& bytes, const char* end);
+void readGameRecord(const char* bytes, const char* end, LoggedGame& game);
+bool rebuildBoard(const LoggedGame& game, BoardGraph& graph);
+WordVerdict replayVerdict(const BoardGraph& graph, const DictionaryTrie& trie, const LoggedGame& game,
+                          const string& word, Set<string>& found);
+string verdictName(WordVerdict verdict);
+
+
+/*************************************************
+ *                  FUNCTIONS                    *
+ ************************************************/
+
+/* The header is written only when the file is new or empty; an existing log is checked
+ * before anything is appended to it. */
+GameLogWriter::GameLogWriter(const string& filename) : lastTime(0) {
+    ifstream existing(filename.c_str(), ios::binary | ios::ate);
+    bool empty = !existing || existing.tellg() == 0;
+    if(!empty) {
+        char header[LOG_HEADER_SIZE];
+        existing.seekg(0);
+        uint32_t version = 0;
+        if(!existing.read(header, sizeof(header)) || memcmp(header, LOG_MAGIC, sizeof(LOG_MAGIC)) != 0) {
+            error("GameLogWriter: " + filename + " is not a game log");
+        }
+        memcpy(&version, header + sizeof(LOG_MAGIC), sizeof(version));
+        if(version != LOG_VERSION) {
+            error("GameLogWriter: " + filename + " has unsupported version " + integerToString(version));
+        }
+    }
+    existing.close();
+    output.open(filename.c_str(), ios::binary | ios::app);
+    if(!output) {
+        error("GameLogWriter: cannot open " + filename);
+    }
+    if(empty) {
+        output.write(LOG_MAGIC, sizeof(LOG_MAGIC));
+        output.write(reinterpret_cast<const char*>(&LOG_VERSION), sizeof(LOG_VERSION));
+        output.flush();
+    }
+}
+
+void GameLogWriter::startGame(const BoardGraph& graph, DiceRule rule, const GameRules& rules,
+                              uint32_t dictionaryFingerprint) {
+    lastTime = currentTimeMillis();
+    string record(1, (char) GAME_RECORD);
+    appendVarint(record, lastTime);
+    appendVarint(record, dictionaryFingerprint);
+    appendVarint(record, rule);
+    appendLogString(record, rules.name);
+    appendVarint(record, rules.minLength);
+    appendVarint(record, rules.maxLength);
+    appendVarint(record, rules.quRule);
+    appendVarint(record, rules.points.size());
+    for(int points : rules.points) {
+        appendVarint(record, points);
+    }
+    appendVarint(record, graph.shape);
+    appendVarint(record, graph.rows);
+    appendVarint(record, graph.cols);
+    appendLogString(record, string(graph.letters.begin(), graph.letters.end()));
+    writeRecord(record);
+}
+
+void GameLogWriter::recordWord(const string& word, WordVerdict verdict) {
+    int64_t now = currentTimeMillis();
+    string record(1, (char) WORD_RECORD);
+    appendVarint(record, max<int64_t>(now - lastTime, 0));
+    appendVarint(record, verdict);
+    appendLogString(record, word);
+    writeRecord(record);
+    lastTime = now;
+}
+
+void GameLogWriter::recordSolution(const Vector<int>& wordIds) {
+    int64_t now = currentTimeMillis();
+    string record(1, (char) SOLUTION_RECORD);
+    appendVarint(record, max<int64_t>(now - lastTime, 0));
+    appendVarint(record, wordIds.size());
+    int previous = 0;
+    for(int id : wordIds) {
+        appendVarint(record, id - previous);
+        previous = id;
+    }
+    writeRecord(record);
+    lastTime = now;
+}
+
+void GameLogWriter::endGame(int humanScore, int computerScore) {
+    int64_t now = currentTimeMillis();
+    string record(1, (char) END_RECORD);
+    appendVarint(record, max<int64_t>(now - lastTime, 0));
+    appendVarint(record, humanScore);
+    appendVarint(record, computerScore);
+    writeRecord(record);
+    output.flush();
+    lastTime = now;
+}
+
+/* The payload length goes between the type byte and the payload, so the record is rebuilt
+ * around it before the single write. */
+void GameLogWriter::writeRecord(const string& record) {
+    string bytes = record.substr(0, 1);
+    appendVarint(bytes, record.length() - 1);
+    bytes.append(record, 1, string::npos);
+    output.write(bytes.data(), bytes.length());
+    if(!output) {
+        error("GameLogWriter: cannot write the game log");
+    }
+}
+
+/* The file is mapped, so reading costs no more than decoding the records. A game is visited
+ * when the next one starts or the log ends. */
+void readGameLog(const string& filename, const function<void(const LoggedGame& game)>& visit) {
+    MappedFile file(filename);
+    if(file.size() < LOG_HEADER_SIZE || memcmp(file.data(), LOG_MAGIC, sizeof(LOG_MAGIC)) != 0) {
+        error("readGameLog: " + filename + " is not a game log");
+    }
+    uint32_t version;
+    memcpy(&version, file.data() + sizeof(LOG_MAGIC), sizeof(version));
+    if(version != LOG_VERSION) {
+        error("readGameLog: " + filename + " has unsupported version " + integerToString(version));
+    }
+    const char* bytes = file.data() + LOG_HEADER_SIZE;
+    const char* end = file.data() + file.size();
+    LoggedGame game;
+    bool inGame = false;
+    int64_t time = 0;
+    while(bytes < end) {
+        const char* record = bytes;
+        uint8_t type = *record++;
+        uint64_t length;
+        try {
+            length = readVarint(record, end);
+        } catch(ErrorException&) {
+            break;    // a record cut off by a crash ends the log
+        }
+        if(length > (uint64_t) (end - record)) {
+            break;
+        }
+        const char* payload = record;
+        const char* payloadEnd = record + length;
+        bytes = payloadEnd;
+        if(type == GAME_RECORD) {
+            if(inGame) {
+                visit(game);
+            }
+            readGameRecord(payload, payloadEnd, game);
+            time = game.startTime;
+            inGame = true;
+        } else if(type == WORD_RECORD && inGame) {
+            LoggedWord word;
+            time += readVarint(payload, payloadEnd);
+            word.time = time;
+            word.verdict = (WordVerdict) readVarint(payload, payloadEnd);
+            word.word = readLogString(payload, payloadEnd);
+            game.words.add(word);
+        } else if(type == SOLUTION_RECORD && inGame) {
+            time += readVarint(payload, payloadEnd);
+            uint64_t count = readVarint(payload, payloadEnd);
+            if(count > (uint64_t) (payloadEnd - payload)) {
+                error("readGameLog: corrupt solution in " + filename);
+            }
+            game.solution.clear();
+            int id = 0;
+            for(uint64_t i = 0; i < count; i++) {
+                id += readVarint(payload, payloadEnd);
+                game.solution.add(id);
+            }
+            game.solved = true;
+        } else if(type == END_RECORD && inGame) {
+            time += readVarint(payload, payloadEnd);
+            game.humanScore = readVarint(payload, payloadEnd);
+            game.computerScore = readVarint(payload, payloadEnd);
+            game.finished = true;
+        }
+    }
+    if(inGame) {
+        visit(game);
+    }
+}
+
+/* Each game is replayed on its own board with a fresh set of found words; a game whose
+ * board cannot be rebuilt is counted and skipped. */
+ReplayReport replayGameLog(const string& filename, const DictionaryTrie& trie,
+                           const function<void(const LoggedGame& game, const string& problem)>& mismatch) {
+    ReplayReport report = {0, 0, 0, 0, 0};
+    readGameLog(filename, [&](const LoggedGame& game) {
+        report.games++;
+        BoardGraph graph;
+        if(!rebuildBoard(game, graph)) {
+            report.skippedGames++;
+            return;
+        }
+        Set<string> found;
+        for(const LoggedWord& logged : game.words) {
+            report.events++;
+            if(logged.verdict == HINT_REQUESTED) {
+                continue;
+            }
+            WordVerdict verdict = replayVerdict(graph, trie, game, logged.word, found);
+            if(verdict != logged.verdict) {
+                report.verdictMismatches++;
+                if(mismatch) {
+                    mismatch(game, "\"" + logged.word + "\" was " + verdictName(logged.verdict) +
+                             " but is now " + verdictName(verdict));
+                }
+            }
+        }
+        if(game.solved && game.dictionaryFingerprint != trie.fingerprint()) {
+            report.events++;
+            report.solutionMismatches++;
+            if(mismatch) {
+                mismatch(game, "the game was logged with a different dictionary (fingerprint " +
+                         to_string(game.dictionaryFingerprint) + ", now " + to_string(trie.fingerprint()) +
+                         "), so the board's solution cannot be checked");
+            }
+        } else if(game.solved) {
+            report.events++;
+            SolveOptions options;
+            options.rule = game.rule;
+            Map<int, string> wildcardSpellings;
+            Vector<int> solution = solveWithRules(graph, trie, game.rules, options, wildcardSpellings);
+            if(!(solution == game.solution)) {
+                report.solutionMismatches++;
+                if(mismatch) {
+                    mismatch(game, "the board had " + integerToString(game.solution.size()) +
+                             " words but now has " + integerToString(solution.size()));
+                }
+            }
+        }
+        report.events += game.finished ? 1 : 0;
+    });
+    return report;
+}
+
+/* Returns the time of day in milliseconds since the Unix epoch. */
+int64_t currentTimeMillis() {
+    return chrono::duration_cast<chrono::milliseconds>(
+               chrono::system_clock::now().time_since_epoch()).count();
+}
+
+/* Appends value as an unsigned LEB128 varint: seven bits per byte, low bits first, with the
+ * high bit set on every byte but the last. */
+void appendVarint(string& bytes, uint64_t value) {
+    while(value >= 0x80) {
+        bytes += (char) (value | 0x80);
+        value >>= 7;
+    }
+    bytes += (char) value;
+}
+
+void appendLogString(string& bytes, const string& text) {
+    appendVarint(bytes, text.length());
+    bytes += text;
+}
+
+/* Reads a varint and advances bytes past it; throws an ErrorException if it runs past end. */
+uint64_t readVarint(const char*& bytes, const char* end) {
+    uint64_t value = 0;
+    for(int shift = 0; shift < 64; shift += 7) {
+        if(bytes == end) {
+            error("readVarint: unexpected end of record");
+        }
+        uint8_t byte = *bytes++;
+        value |= (uint64_t) (byte & 0x7F) << shift;
+        if(byte < 0x80) {
+            return value;
+        }
+    }
+    error("readVarint: varint too long");
+    return 0;
+}
+
+string readLogString(const char*& bytes, const char* end) {
+    uint64_t length = readVarint(bytes, end);
+    if(length > (uint64_t) (end - bytes)) {
+        error("readLogString: unexpected end of record");
+    }
+    string text(bytes, length);
+    bytes += length;
+    return text;
+}
+
+/* Starts game over from a GAME record. */
+void readGameRecord(const char* bytes, const char* end, LoggedGame& game) {
+    game = LoggedGame();
+    game.startTime = readVarint(bytes, end);
+    game.dictionaryFingerprint = readVarint(bytes, end);
+    game.rule = (DiceRule) readVarint(bytes, end);
+    game.rules.name = readLogString(bytes, end);
+    game.rules.minLength = readVarint(bytes, end);
+    game.rules.maxLength = readVarint(bytes, end);
+    game.rules.quRule = (QuRule) readVarint(bytes, end);
+    uint64_t pointCount = readVarint(bytes, end);
+    if(pointCount > (uint64_t) (end - bytes)) {
+        error("readGameRecord: corrupt point table");
+    }
+    for(uint64_t i = 0; i < pointCount; i++) {
+        game.rules.points.add(readVarint(bytes, end));
+    }
+    game.shape = (BoardGraph::Shape) readVarint(bytes, end);
+    game.rows = readVarint(bytes, end);
+    game.cols = readVarint(bytes, end);
+    game.letters = readLogString(bytes, end);
+    game.solved = false;
+    game.finished = false;
+    game.humanScore = 0;
+    game.computerScore = 0;
+}
+
+/* Rebuilds the board of a logged game. Returns false for custom boards, whose adjacency is
+ * not logged, and for letters that do not fit the logged dimensions. */
+bool rebuildBoard(const LoggedGame& game, BoardGraph& graph) {
+    int cells = game.rows * game.cols;
+    if(game.shape == BoardGraph::CUBE) {
+        if(game.cols <= 0 || (int) game.letters.length() != game.cols * game.cols * game.cols) {
+            return false;
+        }
+        Vector<char> letters;
+        for(char letter : game.letters) {
+            letters.add(letter);
+        }
+        graph = cubeBoardGraph(letters, game.cols);
+        return true;
+    }
+    if(game.shape == BoardGraph::CUSTOM || game.rows <= 0 || game.cols <= 0 ||
+       (int) game.letters.length() != cells) {
+        return false;
+    }
+    Grid<char> board(game.rows, game.cols);
+    for(int i = 0; i < cells; i++) {
+        board[i / game.cols][i % game.cols] = game.letters[i];
+    }
+    if(game.shape == BoardGraph::TORUS) {
+        graph = torusBoardGraph(board);
+    } else if(game.shape == BoardGraph::HEXAGON) {
+        graph = hexBoardGraph(board);
+    } else {
+        graph = gridBoardGraph(board);
+    }
+    return true;
+}
+
+/* Decides a submitted word the way the game does: words outside the dictionary or the rules
+ * are rejected before repeats, and only words that can be formed count as found. */
+WordVerdict replayVerdict(const BoardGraph& graph, const DictionaryTrie& trie, const LoggedGame& game,
+                          const string& word, Set<string>& found) {
+    if(!trie.contains(word) || !game.rules.allows(word)) {
+        return WORD_REJECTED;
+    } else if(found.contains(word)) {
+        return WORD_REPEATED;
+    } else if(findWordPath(graph, word, game.rule).isEmpty()) {
+        return WORD_NOT_ON_BOARD;
+    }
+    found.add(word);
+    return WORD_ACCEPTED;
+}
+
+string verdictName(WordVerdict verdict) {
+    switch(verdict) {
+    case WORD_ACCEPTED: return "accepted";
+    case WORD_REPEATED: return "a repeat";
+    case WORD_NOT_ON_BOARD: return "not on the board";
+    case WORD_REJECTED: return "rejected";
+    default: return "a hint";
+    }
+}
@@ -0,0 +1,118 @@
+/* GAME LOG
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * Records every game as a compact binary event log, and replays logs at full speed. A game is
+ * logged as its board, rules, and dictionary fingerprint, followed by one event per word the
+ * player submitted with the verdict it got, the ids of every word on the board, and the final
+ * scores. Every event carries the milliseconds since the previous one. Numbers are stored as
+ * variable-length integers and the ids as gaps between consecutive ids, so a typical game
+ * takes a few hundred bytes. The board's solution is logged rather than the computer's words,
+ * which leave out the player's and may be limited to an easier opponent's tier, so the
+ * logged computer score is a record of the game and is not checked.
+ *
+ * Replaying a log rebuilds each board and checks every logged verdict and solution against
+ * the current solver and dictionary, with no GUI and no pauses. It is used to verify
+ * a new solver or dictionary against past games, and as a load test. */
+
+#ifndef _gamelog_h
+#define _gamelog_h
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+#include "boardgraph.h"
+#include "dictionarytrie.h"
+#include "gamerules.h"
+#include "vector.h"
+#include "wordsolver.h"
+
+/* Default log file of the game, appended to by every game played. */
+const std::string GAME_LOG_FILE = "games.log";
+
+/* What happened to a word the player typed. */
+enum WordVerdict {
+    WORD_ACCEPTED,         // a new word found on the board
+    WORD_REPEATED,         // a word the player had already found
+    WORD_NOT_ON_BOARD,     // a valid word that cannot be formed on the board
+    WORD_REJECTED,         // not in the dictionary, or not allowed by the rules
+    HINT_REQUESTED         // the player asked for a hint instead
+};
+
+struct LoggedWord {
+    int64_t time;          // milliseconds since the Unix epoch
+    std::string word;
+    WordVerdict verdict;
+};
+
+struct LoggedGame {
+    int64_t startTime;     // milliseconds since the Unix epoch
+    uint32_t dictionaryFingerprint;
+    DiceRule rule;
+    GameRules rules;
+    BoardGraph::Shape shape;
+    int rows;
+    int cols;
+    std::string letters;   // the board's letters in cell order
+    Vector<LoggedWord> words;
+    bool solved;           // true if the board's solution was logged
+    Vector<int> solution;  // ids of every word on the board, not just the computer's
+    bool finished;         // true if the final scores were logged
+    int humanScore;
+    int computerScore;
+};
+
+class GameLogWriter {
+public:
+    /* Opens the log for appending, starting a new file if it does not exist. Throws an
+     * ErrorException if it cannot be opened or is not a game log. */
+    GameLogWriter(const std::string& filename);
+
+    /* Starts logging a game on the given board. */
+    void startGame(const BoardGraph& graph, DiceRule rule, const GameRules& rules,
+                   uint32_t dictionaryFingerprint);
+
+    void recordWord(const std::string& word, WordVerdict verdict);
+
+    /* Records the board's full solution, the ids of every word on it in increasing order,
+     * from which the player's and the computer's words were both drawn. */
+    void recordSolution(const Vector<int>& wordIds);
+
+    /* Records the final scores and flushes the game to the file. */
+    void endGame(int humanScore, int computerScore);
+
+private:
+    GameLogWriter(const GameLogWriter&) = delete;
+    GameLogWriter& operator=(const GameLogWriter&) = delete;
+
+    void writeRecord(const std::string& record);
+
+    std::ofstream output;
+    int64_t lastTime;       // time of the last event, which the next one is stored relative to
+};
+
+/* Calls visit with every game of the log, in the order they were played. A game cut short by
+ * the end of the file is still visited, without its missing events. Throws an ErrorException
+ * if the file is not a game log or is corrupt. */
+void readGameLog(const std::string& filename, const std::function<void(const LoggedGame& game)>& visit);
+
+struct ReplayReport {
+    int games;
+    long events;
+    int skippedGames;       // games whose board could not be rebuilt
+    int verdictMismatches;  // words whose verdict would now be different
+    int solutionMismatches; // games whose board's solution would now be different, or was
+                            // logged with another dictionary
+};
+
+/* Replays every game of the log against the given dictionary. Each logged verdict is decided
+ * again, and each logged solution is compared id by id with a fresh solve. The ids of a game
+ * logged with another dictionary name other words and cannot be compared, so its solution
+ * counts as a mismatch. mismatch, if given, is called with each game and a
+ * description of every difference found. */
+ReplayReport replayGameLog(const std::string& filename, const DictionaryTrie& trie,
+                           const std::function<void(const LoggedGame& game,
+                                                    const std::string& problem)>& mismatch = nullptr);
+
+#endif // _gamelog_h
@@ -0,0 +1,82 @@
+/* GAME RULES
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * Implements GameRules and the predefined rule sets. */
+
+#include "gamerules.h"
+#include <algorithm>
+using namespace std;
+
+/* The classic point table, indexed by word length. */
+const Vector<int> STANDARD_POINTS = {0, 0, 0, 0, 1, 2, 3, 5, 11};
+
+/*************************************************
+ *                  FUNCTIONS                    *
+ ************************************************/
+
+int GameRules::length(const string& word) const {
+    int letters = word.length();
+    if(quRule == QU_ONE_LETTER) {
+        for(size_t i = word.find("QU"); i != string::npos; i = word.find("QU", i + 2)) {
+            letters--;
+        }
+    }
+    return letters;
+}
+
+bool GameRules::allows(const string& word) const {
+    int letters = length(word);
+    return letters >= minLength && (maxLength == 0 || letters <= maxLength);
+}
+
+int GameRules::score(const string& word) const {
+    return points.isEmpty() ? 0 : points[min(length(word), points.size() - 1)];
+}
+
+/* A word with n QUs has n more letters than its length under QU_ONE_LETTER, and at most
+ * every other letter can start a QU, so maxLength counted that way allows at most
+ * 2 * maxLength letters. */
+SolveOptions GameRules::solveOptions() const {
+    SolveOptions options;
+    options.minLength = minLength;
+    options.maxLength = quRule == QU_ONE_LETTER ? 2 * maxLength : maxLength;
+    return options;
+}
+
+Vector<int> solveWithRules(const BoardGraph& graph, const DictionaryTrie& trie, const GameRules& rules,
+                           SolveOptions options, Map<int, string>& wildcardSpellings) {
+    SolveOptions limits = rules.solveOptions();
+    options.minLength = limits.minLength;
+    options.maxLength = limits.maxLength;
+    Vector<int> ids = solveBoard(graph, trie, options, wildcardSpellings);
+    if(rules.quRule != QU_ONE_LETTER) {
+        return ids;
+    }
+    Vector<int> allowed;
+    for(int id : ids) {
+        if(rules.allows(trie.word(id))) {
+            allowed.add(id);
+        } else {
+            wildcardSpellings.remove(id);
+        }
+    }
+    return allowed;
+}
+
+GameRules standardRules() {
+    return GameRules {"Standard", MIN_WORD_LENGTH, 0, STANDARD_POINTS, QU_TWO_LETTERS};
+}
+
+/* Besides the standard rules: three-letter words scoring a point each, as in the original
+ * game; QU counted as one letter, as on cubes that print it on one face; a speed round in
+ * which only short words count; and a round in which only long words count. */
+Vector<GameRules> ruleSets() {
+    return {
+        standardRules(),
+        GameRules {"Three-letter words", 3, 0, {0, 0, 0, 1, 1, 2, 3, 5, 11}, QU_TWO_LETTERS},
+        GameRules {"Qu counts as one letter", MIN_WORD_LENGTH, 0, STANDARD_POINTS, QU_ONE_LETTER},
+        GameRules {"Speed (3 to 5 letters)", 3, 5, {0, 0, 0, 1, 2, 4}, QU_TWO_LETTERS},
+        GameRules {"Long words (6 letters or more)", 6, 0, {0, 0, 0, 0, 0, 0, 3, 5, 11}, QU_TWO_LETTERS}
+    };
+}
@@ -0,0 +1,67 @@
+/* GAME RULES
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * The scoring rules of one game, chosen at runtime: which word lengths count, how many points
+ * each length is worth, and whether the letters QU count as one letter or two. A handful of
+ * common rule sets are predefined, and several games with different rules can run side by
+ * side, since nothing here is global.
+ *
+ * The solver only needs the length limits, which it takes through SolveOptions; its search is
+ * compiled once with and once without the longest-word check, and the variant is picked once
+ * per board, so no rule is consulted per step. Points are looked up in a table indexed by
+ * length rather than computed with a chain of comparisons. */
+
+#ifndef _gamerules_h
+#define _gamerules_h
+
+#include <string>
+#include "boardgraph.h"
+#include "dictionarytrie.h"
+#include "map.h"
+#include "vector.h"
+#include "wordsolver.h"
+
+/* How the letters QU count toward a word's length. */
+enum QuRule {
+    QU_TWO_LETTERS,    // every letter counts
+    QU_ONE_LETTER      // each QU counts as a single letter, as if printed on one cube face
+};
+
+struct GameRules {
+    std::string name;
+    int minLength;       // shortest word that counts
+    int maxLength;       // longest word that counts, or 0 for no limit
+    Vector<int> points;  // points[n] is the score of a word of length n; longer words score the last entry
+    QuRule quRule;
+
+    /* Returns the length of the uppercase word under the Qu rule. */
+    int length(const std::string& word) const;
+
+    /* Returns true if the uppercase word's length is within the limits. */
+    bool allows(const std::string& word) const;
+
+    /* Returns the points the uppercase word scores, ignoring the length limits. */
+    int score(const std::string& word) const;
+
+    /* Returns solver options whose length limits report at least every word these rules allow.
+     * Under QU_ONE_LETTER the solver's limits, which count every letter, are looser than the
+     * rules, so its words must still be checked with allows. */
+    SolveOptions solveOptions() const;
+};
+
+/* Solves the board like solveBoard, reporting only the words the rules allow. The length
+ * limits of the options are replaced by those of the rules; when QU counts as one letter, the
+ * words the solver finds are checked again, and those dropped are also removed from
+ * wildcardSpellings. */
+Vector<int> solveWithRules(const BoardGraph& graph, const DictionaryTrie& trie, const GameRules& rules,
+                           SolveOptions options, Map<int, std::string>& wildcardSpellings);
+
+/* Returns the classic rules: words of MIN_WORD_LENGTH letters or more, scored 1, 2, 3, 5, and
+ * 11 points for 4, 5, 6, 7, and 8 or more letters. */
+GameRules standardRules();
+
+/* Returns the predefined rule sets, starting with the standard rules. */
+Vector<GameRules> ruleSets();
+
+#endif // _gamerules_h
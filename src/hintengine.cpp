@@ -0,0 +1,83 @@
+/* HINT ENGINE
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * Implements HintEngine. The starting cell of a word is only looked up when a hint asks for
+ * it, with a search for that single word. */
+
+#include "hintengine.h"
+#include <algorithm>
+#include "strlib.h"
+using namespace std;
+
+/*************************************************
+ *             PROTOTYPE FUNCTIONS               *
+ ************************************************/
+string describeCell(const BoardGraph& graph, int cell);
+
+
+/*************************************************
+ *                  FUNCTIONS                    *
+ ************************************************/
+
+HintEngine::HintEngine(const BoardGraph& graph, const DictionaryTrie& trie, const Vector<int>& solution,
+                       DiceRule rule)
+    : graph(graph), trie(trie), rule(rule), ranked(solution.begin(), solution.end()),
+      found(solution.size(), false), best(0), unfound(solution.size()), hintsGiven(0) {
+    stable_sort(ranked.begin(), ranked.end(), [&](int a, int b) {
+        return trie.word(a).length() > trie.word(b).length();
+    });
+    for(int i = 0; i < (int) ranked.size(); i++) {
+        rankOf[ranked[i]] = i;
+    }
+}
+
+/* Moving past found words is amortized over the whole turn, since best only moves forward. */
+void HintEngine::markFound(const string& word) {
+    int node = trie.find(toUpperCase(word));
+    if(node == DictionaryTrie::NONE || !rankOf.count(trie.wordId(node))) {
+        return;
+    }
+    int rank = rankOf[trie.wordId(node)];
+    if(!found[rank]) {
+        found[rank] = true;
+        unfound--;
+    }
+    while(best < (int) ranked.size() && found[best]) {
+        best++;
+        hintsGiven = 0;
+    }
+}
+
+/* The first hint about a word is its length, the second its starting cell, and each later
+ * one reveals one more of its letters, stopping one short of the whole word. */
+Hint HintEngine::nextHint() {
+    if(best == (int) ranked.size()) {
+        return Hint {"You have found every word on this board!", -1};
+    }
+    const string& word = trie.word(ranked[best]);
+    int level = hintsGiven++;
+    if(level == 0) {
+        return Hint {"You have not found a word of " + integerToString(word.length()) + " letters.", -1};
+    }
+    if(level == 1) {
+        Vector<int> path = findWordPath(graph, word, rule);
+        int cell = path.isEmpty() ? -1 : path[0];
+        return Hint {"It starts at " + describeCell(graph, cell) + ".", cell};
+    }
+    int letters = min(level - 1, (int) word.length() - 1);
+    return Hint {"It starts with \"" + word.substr(0, letters) + "\".", -1};
+}
+
+/* Names a cell by its (1-based) row and column, and its layer on the cube board. */
+string describeCell(const BoardGraph& graph, int cell) {
+    if(cell == -1) {
+        return "an unknown cell";
+    }
+    string column = ", column " + integerToString(graph.col(cell) + 1);
+    if(graph.shape == BoardGraph::CUBE) {
+        return "layer " + integerToString(graph.row(cell) / graph.cols + 1) + ", row " +
+               integerToString(graph.row(cell) % graph.cols + 1) + column;
+    }
+    return "row " + integerToString(graph.row(cell) + 1) + column;
+}
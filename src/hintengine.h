@@ -0,0 +1,57 @@
+/* HINT ENGINE
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * Gives the player hints during their turn. The words the computer found on the board are
+ * ranked once, longest (and so highest-scoring) first, and each hint is about the best word
+ * the player has not found yet. Asking again about the same word reveals more: first its
+ * length, then its starting cell, then its first letter, its first two letters, and so on.
+ * Marking a word found only moves a cursor past it, so hints stay instant however many words
+ * the player finds, and the board is never searched again. */
+
+#ifndef _hintengine_h
+#define _hintengine_h
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "boardgraph.h"
+#include "dictionarytrie.h"
+#include "vector.h"
+#include "wordsolver.h"
+
+struct Hint {
+    std::string text;   // the hint to show the player
+    int cell;           // the starting cell the hint reveals, or -1
+};
+
+class HintEngine {
+public:
+    /* Ranks the given solution of the board: the word ids solveBoard found with the rule. */
+    HintEngine(const BoardGraph& graph, const DictionaryTrie& trie, const Vector<int>& solution,
+               DiceRule rule);
+
+    /* Records that the player found the word; words that are not in the solution are ignored. */
+    void markFound(const std::string& word);
+
+    /* Returns the next hint, or a hint with no cell saying that every word has been found. */
+    Hint nextHint();
+
+    /* Returns the number of words in the solution the player has not found. */
+    int remaining() const {
+        return unfound;
+    }
+
+private:
+    const BoardGraph& graph;
+    const DictionaryTrie& trie;
+    DiceRule rule;
+    std::vector<int> ranked;                 // word ids, best first
+    std::unordered_map<int, int> rankOf;     // word id to its index in ranked
+    std::vector<char> found;                 // found[i] is true if ranked[i] was found
+    int best;                                // index in ranked of the best unfound word
+    int unfound;
+    int hintsGiven;                          // hints given so far about ranked[best]
+};
+
+#endif // _hintengine_h
@@ -0,0 +1,113 @@
+/* HUGE PAGES
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * Implements the huge page allocator with mmap where it is available, falling back to new. */
+
+#include "hugepages.h"
+#include <atomic>
+#include <cstdint>
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+using namespace std;
+
+atomic<bool> hugePagesEnabled(true);
+atomic<size_t> explicitHugePageBytes(0);
+atomic<size_t> transparentHugePageBytes(0);
+atomic<size_t> normalHugePageBytes(0);
+
+/*************************************************
+ *             PROTOTYPE FUNCTIONS               *
+ ************************************************/
+size_t hugePageRound(size_t bytes);
+void* mapAlignedToHugePage(size_t length);
+
+
+/*************************************************
+ *                  FUNCTIONS                    *
+ ************************************************/
+
+/* Each mapped block is a whole number of huge pages starting on a huge page boundary, so that
+ * the last huge page is not shared with other data and freeing only needs the length. */
+void* allocateHugePages(size_t bytes) {
+#ifndef _WIN32
+    if(bytes >= HUGE_PAGE_SIZE) {
+        size_t length = hugePageRound(bytes);
+        void* address = MAP_FAILED;
+        bool enabled = hugePagesEnabled;
+#ifdef MAP_HUGETLB
+        if(enabled) {
+            address = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if(address != MAP_FAILED) {
+                explicitHugePageBytes += length;
+                return address;
+            }
+        }
+#endif
+        address = mapAlignedToHugePage(length);
+        if(address == nullptr) {
+            throw bad_alloc();
+        }
+#ifdef MADV_HUGEPAGE
+        if(enabled && madvise(address, length, MADV_HUGEPAGE) == 0) {
+            transparentHugePageBytes += length;
+            return address;
+        }
+#endif
+        normalHugePageBytes += length;
+        return address;
+    }
+#endif
+    return ::operator new(bytes);
+}
+
+void freeHugePages(void* address, size_t bytes) {
+#ifndef _WIN32
+    if(bytes >= HUGE_PAGE_SIZE) {
+        munmap(address, hugePageRound(bytes));
+        return;
+    }
+#endif
+    ::operator delete(address);
+}
+
+void setHugePagesEnabled(bool enabled) {
+    hugePagesEnabled = enabled;
+}
+
+/* The counters only grow, since a block's backing is not known when it is freed, so they
+ * describe every block allocated so far. */
+HugePageUsage hugePageUsage() {
+    return HugePageUsage {explicitHugePageBytes, transparentHugePageBytes, normalHugePageBytes};
+}
+
+/* Rounds bytes up to a whole number of huge pages. */
+size_t hugePageRound(size_t bytes) {
+    return (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+}
+
+/* mmap only promises page alignment, so one extra huge page is mapped and the unaligned head
+ * and the leftover tail are unmapped again. Returns nullptr if the mapping fails. */
+void* mapAlignedToHugePage(size_t length) {
+#ifndef _WIN32
+    void* address = mmap(nullptr, length + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(address == MAP_FAILED) {
+        return nullptr;
+    }
+    uintptr_t start = reinterpret_cast<uintptr_t>(address);
+    uintptr_t aligned = (start + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    if(aligned > start) {
+        munmap(address, aligned - start);
+    }
+    size_t tail = start + length + HUGE_PAGE_SIZE - (aligned + length);
+    if(tail > 0) {
+        munmap(reinterpret_cast<void*>(aligned + length), tail);
+    }
+    return reinterpret_cast<void*>(aligned);
+#else
+    return nullptr;
+#endif
+}
@@ -0,0 +1,77 @@
+/* HUGE PAGES
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * An allocator for large, randomly accessed arrays such as the trie's node array. The solver
+ * jumps between nodes all over a multi-megabyte array, and with 4 KB pages nearly every jump
+ * needs a different TLB entry; a 2 MB page covers the whole array with a handful of entries.
+ *
+ * Blocks of at least one huge page are mapped directly. Explicit huge pages (MAP_HUGETLB) are
+ * tried first, which only succeeds if the system has a huge page pool; otherwise the block is
+ * aligned to a huge page boundary and marked with MADV_HUGEPAGE so that transparent huge pages
+ * can back it. If neither is available, or on systems without mmap, the memory is ordinary.
+ * Smaller blocks are always allocated with new, since they would not fill a huge page. */
+
+#ifndef _hugepages_h
+#define _hugepages_h
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+/* Size of the huge pages requested, and the smallest block mapped as huge pages. */
+const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+/* How many bytes of the live huge page blocks got each kind of backing. */
+struct HugePageUsage {
+    size_t explicitBytes;       // from the huge page pool
+    size_t transparentBytes;    // advised for transparent huge pages
+    size_t normalBytes;         // neither was available or huge pages were disabled
+};
+
+/* Allocates bytes, on huge pages if the block is big enough and they are available. */
+void* allocateHugePages(size_t bytes);
+
+/* Frees a block from allocateHugePages; bytes must be the size it was allocated with. */
+void freeHugePages(void* address, size_t bytes);
+
+/* Turns the use of huge pages for later allocations on or off; they are on by default. Blocks
+ * allocated while they are off still go through mmap, so they are freed the same way. */
+void setHugePagesEnabled(bool enabled);
+
+HugePageUsage hugePageUsage();
+
+/* A standard allocator over allocateHugePages, for std::vector and other containers. */
+template <typename T>
+struct HugePageAllocator {
+    typedef T value_type;
+
+    HugePageAllocator() = default;
+
+    template <typename U>
+    HugePageAllocator(const HugePageAllocator<U>&) {}
+
+    T* allocate(size_t count) {
+        return static_cast<T*>(allocateHugePages(count * sizeof(T)));
+    }
+
+    void deallocate(T* address, size_t count) {
+        freeHugePages(address, count * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator==(const HugePageAllocator<U>&) const {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const HugePageAllocator<U>&) const {
+        return false;
+    }
+};
+
+/* A std::vector whose storage is on huge pages once it is big enough. */
+template <typename T>
+using HugePageVector = std::vector<T, HugePageAllocator<T>>;
+
+#endif // _hugepages_h
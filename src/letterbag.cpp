@@ -0,0 +1,267 @@
+/* LETTER BAG
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * Implements the letter bag search. The bag is packed the same way as the dictionary's letter
+ * counts, with the top bit of every field set; subtracting a word's counts from it then
+ * clears a field's top bit exactly when the bag is short of that letter, so one subtraction
+ * per half checks all 26 letters of a word. The whole word list is scanned this way without
+ * branching on each word, which beats walking the trie once the bag holds more than a few
+ * letters, since most prefixes can then be spelled and the walk visits most of the trie. */
+
+#include "letterbag.h"
+#include <algorithm>
+#include <climits>
+#include <memory>
+#include <vector>
+#include "strlib.h"
+using namespace std;
+
+/* The top bit of every four-bit field of each half of a packed bag. */
+const uint64_t LOW_FIELD_BITS = 0x8888888888888888ULL;
+const uint64_t HIGH_FIELD_BITS = 0x0000008888888888ULL;
+
+/*************************************************
+ *             PROTOTYPE FUNCTIONS               *
+ ************************************************/
+PackedLetterCounts packBag(const LetterBag& bag);
+int blanksNeeded(const PackedLetterCounts& bag, const PackedLetterCounts& word, int blanks);
+uint64_t saturatingMultiply(uint64_t a, uint64_t b);
+template <typename Trie>
+Vector<int> walkAnagrams(const Trie& trie, const LetterBag& bag, int minLength, int maxLength);
+template <typename Trie>
+void anagramWalk(const Trie& trie, int node, int length, int counts[], int blanks, int minLength,
+                 int maxLength, Vector<int>& ids);
+
+
+/*************************************************
+ *                  FUNCTIONS                    *
+ ************************************************/
+LetterBag letterBag(const string& letters) {
+    LetterBag bag;
+    fill(bag.counts, bag.counts + ALPHABET_SIZE, 0);
+    bag.blanks = 0;
+    for(char ch : letters) {
+        if(ch == BOARD_WILDCARD) {
+            bag.blanks++;
+        } else if(letterIndex(ch) != -1) {
+            bag.counts[letterIndex(ch)]++;
+        }
+    }
+    return bag;
+}
+
+LetterBag letterBag(const BoardGraph& graph) {
+    return letterBag(string(graph.letters.begin(), graph.letters.end()));
+}
+
+/* Without blanks, every word is written to the next slot of the output and kept by
+ * advancing the slot when it passes the packed check, so the loop has no data-dependent
+ * branch. With blanks, each word's shortfall is counted up field by field instead. The few
+ * words with a letter more than 7 times are confirmed by fitsInBag. The ids come out in
+ * increasing order. */
+Vector<int> anagramWords(const DictionaryTrie& trie, const LetterBag& bag, int minLength, int maxLength) {
+    PackedLetterCounts packed = packBag(bag);
+    unsigned lengthRange = (maxLength > 0 ? maxLength : INT_MAX) - (unsigned) minLength;
+    int count = trie.wordCount();
+    int blanks = bag.blanks;
+    unique_ptr<int[]> kept(new int[count + 1]);
+    int found = 0;
+    if(blanks == 0) {
+        for(int id = 0; id < count; id++) {
+            const PackedLetterCounts& word = trie.letterCounts(id);
+            bool fits = (((packed.low - word.low) & LOW_FIELD_BITS) == LOW_FIELD_BITS) &
+                        (((packed.high - word.high) & HIGH_FIELD_BITS) == HIGH_FIELD_BITS);
+            bool inRange = unsigned(word.length() - minLength) <= lengthRange;
+            kept[found] = id;
+            found += fits & inRange;
+        }
+    } else {
+        for(int id = 0; id < count; id++) {
+            const PackedLetterCounts& word = trie.letterCounts(id);
+            if(unsigned(word.length() - minLength) <= lengthRange &&
+               blanksNeeded(packed, word, blanks) <= blanks) {
+                kept[found++] = id;
+            }
+        }
+    }
+    Vector<int> ids;
+    for(int i = 0; i < found; i++) {
+        if(!trie.letterCounts(kept[i]).capped() || fitsInBag(bag, trie.word(kept[i]))) {
+            ids.add(kept[i]);
+        }
+    }
+    return ids;
+}
+
+Vector<int> anagramWords(const LoudsTrie& trie, const LetterBag& bag, int minLength, int maxLength) {
+    return walkAnagrams(trie, bag, minLength, maxLength);
+}
+
+Vector<int> anagramWords(const MappedTrie& trie, const LetterBag& bag, int minLength, int maxLength) {
+    return walkAnagrams(trie, bag, minLength, maxLength);
+}
+
+Vector<int> anagramWords(const TierLimitedTrie& trie, const LetterBag& bag, int minLength, int maxLength) {
+    const DictionaryTrie& dictionary = trie.dictionary();
+    Vector<int> ids;
+    for(int id : anagramWords(dictionary, bag, minLength, maxLength)) {
+        if(dictionary.wordTier(id) <= trie.rarestTier()) {
+            ids.add(id);
+        }
+    }
+    return ids;
+}
+
+/* The walk visits the trie in letter order and records a word before its extensions, so the
+ * ids, which number the words in sorted order, come out increasing. */
+template <typename Trie>
+Vector<int> walkAnagrams(const Trie& trie, const LetterBag& bag, int minLength, int maxLength) {
+    int counts[ALPHABET_SIZE];
+    copy(bag.counts, bag.counts + ALPHABET_SIZE, counts);
+    Vector<int> ids;
+    anagramWalk(trie, Trie::ROOT, 0, counts, bag.blanks, minLength, maxLength > 0 ? maxLength : INT_MAX, ids);
+    return ids;
+}
+
+bool fitsInBag(const LetterBag& bag, const string& word) {
+    int counts[ALPHABET_SIZE];
+    copy(bag.counts, bag.counts + ALPHABET_SIZE, counts);
+    int blanks = bag.blanks;
+    for(char ch : word) {
+        int letter = letterIndex(ch);
+        if(letter != -1 && counts[letter] > 0) {
+            counts[letter]--;
+        } else if(letter == -1 || blanks-- == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+string bagSpelling(const LetterBag& bag, const string& word) {
+    int counts[ALPHABET_SIZE];
+    copy(bag.counts, bag.counts + ALPHABET_SIZE, counts);
+    string spelling = word;
+    for(char& ch : spelling) {
+        int letter = letterIndex(ch);
+        if(letter != -1 && counts[letter] > 0) {
+            counts[letter]--;
+        } else {
+            ch = toLowerCase(ch);
+        }
+    }
+    return spelling;
+}
+
+/* If a letter occurs k times in the word and the bag has n cubes showing it, then j of its
+ * occurrences can be spelled with those cubes in C(k, j) * n! / (n - j)! ways, leaving k - j
+ * occurrences for blank cubes. ways[b] counts the ways to spell the letters handled so far
+ * with b occurrences left for blanks; the b blanks themselves can then be picked from the
+ * bag's blanks in order in blanks! / (blanks - b)! ways. */
+uint64_t bagPathCount(const LetterBag& bag, const string& word) {
+    int occurrences[ALPHABET_SIZE] = {0};
+    for(char ch : word) {
+        if(letterIndex(ch) == -1) {
+            return 0;
+        }
+        occurrences[letterIndex(ch)]++;
+    }
+    vector<uint64_t> ways(word.length() + 1, 0);
+    ways[0] = 1;
+    for(int letter = 0; letter < ALPHABET_SIZE; letter++) {
+        int k = occurrences[letter];
+        if(k == 0) {
+            continue;
+        }
+        vector<uint64_t> next(ways.size(), 0);
+        uint64_t choose = 1;        // C(k, j)
+        uint64_t arrangements = 1;  // n! / (n - j)!
+        for(int j = 0; j <= min(k, bag.counts[letter]); j++) {
+            if(j > 0) {
+                choose = choose * (k - j + 1) / j;
+                arrangements = saturatingMultiply(arrangements, bag.counts[letter] - j + 1);
+            }
+            uint64_t spellings = saturatingMultiply(choose, arrangements);
+            for(int b = 0; b + k - j < (int) ways.size(); b++) {
+                uint64_t added = saturatingMultiply(ways[b], spellings);
+                uint64_t& total = next[b + k - j];
+                total = total + added < total ? UINT64_MAX : total + added;
+            }
+        }
+        ways = next;
+    }
+    uint64_t paths = 0;
+    uint64_t blankArrangements = 1;
+    for(int b = 0; b < (int) ways.size() && b <= bag.blanks; b++) {
+        if(b > 0) {
+            blankArrangements = saturatingMultiply(blankArrangements, bag.blanks - b + 1);
+        }
+        uint64_t added = saturatingMultiply(ways[b], blankArrangements);
+        paths = paths + added < paths ? UINT64_MAX : paths + added;
+    }
+    return paths;
+}
+
+/* Returns the bag's letter counts packed like a word's, capped at 7, with the top bit of every
+ * field set. */
+PackedLetterCounts packBag(const LetterBag& bag) {
+    PackedLetterCounts packed = {LOW_FIELD_BITS, HIGH_FIELD_BITS};
+    for(int letter = 0; letter < ALPHABET_SIZE; letter++) {
+        uint64_t& half = letter < 16 ? packed.low : packed.high;
+        half |= uint64_t(min(bag.counts[letter], 7)) << (4 * (letter % 16));
+    }
+    return packed;
+}
+
+/* Returns the number of the word's letters the bag is short of, or more than blanks if that
+ * number is larger. A field whose top bit was cleared by the subtraction holds 8 minus the
+ * shortfall of its letter. */
+int blanksNeeded(const PackedLetterCounts& bag, const PackedLetterCounts& word, int blanks) {
+    uint64_t differences[2] = {bag.low - word.low, (bag.high - word.high) & ~(~uint64_t(0) << 40)};
+    uint64_t fieldBits[2] = {LOW_FIELD_BITS, HIGH_FIELD_BITS};
+    int needed = 0;
+    for(int half = 0; half < 2 && needed <= blanks; half++) {
+        for(uint64_t lacking = ~differences[half] & fieldBits[half]; lacking != 0; lacking &= lacking - 1) {
+            int shift = __builtin_ctzll(lacking) - 3;
+            needed += 8 - int((differences[half] >> shift) & 7);
+        }
+    }
+    return needed;
+}
+
+/* Adds the words below node, which spells a prefix of the given length, that can be finished
+ * with the letters left in counts and blanks. A letter the bag has run out of takes a blank
+ * if there is one. A node of NONE is a child that the trie's childMask only reported as
+ * possible. */
+template <typename Trie>
+void anagramWalk(const Trie& trie, int node, int length, int counts[], int blanks, int minLength,
+                 int maxLength, Vector<int>& ids) {
+    if(node == Trie::NONE) {
+        return;
+    }
+    if(length >= minLength && trie.wordId(node) != Trie::NONE) {
+        ids.add(trie.wordId(node));
+    }
+    if(length == maxLength) {
+        return;
+    }
+    for(uint32_t letters = trie.childMask(node); letters != 0; letters &= letters - 1) {
+        int letter = __builtin_ctz(letters);
+        if(counts[letter] > 0) {
+            counts[letter]--;
+            anagramWalk(trie, trie.child(node, letter), length + 1, counts, blanks, minLength, maxLength,
+                        ids);
+            counts[letter]++;
+        } else if(blanks > 0) {
+            anagramWalk(trie, trie.child(node, letter), length + 1, counts, blanks - 1, minLength, maxLength,
+                        ids);
+        }
+    }
+}
+
+/* Returns a * b, or the largest uint64_t if the product does not fit. */
+uint64_t saturatingMultiply(uint64_t a, uint64_t b) {
+    uint64_t product;
+    return __builtin_mul_overflow(a, b, &product) ? UINT64_MAX : product;
+}
@@ -0,0 +1,63 @@
+/* LETTER BAG
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * Finds the words that can be built from a board's letters when adjacency does not matter:
+ * each cube may be used once, in any order, as in an anagram game. Only the multiset of
+ * letters on the board counts, so the board is reduced to a count of each letter plus a
+ * number of blank cubes. Those counts are packed like the dictionary's per-word letter
+ * counts, and every word is checked against them with a couple of subtractions, which finds
+ * the words of a 36-cube bag in a fraction of a millisecond. Since the board's shape is
+ * ignored, the result is also an upper bound on the words any arrangement of the same cubes
+ * can hold, which board generators can use to reject a set of letters before searching for
+ * an arrangement. */
+
+#ifndef _letterbag_h
+#define _letterbag_h
+
+#include <cstdint>
+#include <string>
+#include "boardgraph.h"
+#include "dictionarytrie.h"
+#include "loudstrie.h"
+#include "mappedtrie.h"
+#include "vector.h"
+
+struct LetterBag {
+    int counts[ALPHABET_SIZE];  // number of cubes showing each letter
+    int blanks;                 // number of blank cubes
+};
+
+/* Returns the bag of the given letters; BOARD_WILDCARD is a blank cube and any other char
+ * that is not an uppercase letter is ignored. */
+LetterBag letterBag(const std::string& letters);
+
+/* Returns the bag of the letters on the board's cells. */
+LetterBag letterBag(const BoardGraph& graph);
+
+/* Returns the ids of every dictionary word of at least minLength letters, and at most
+ * maxLength unless it is 0, that can be built from the bag, in increasing order. */
+Vector<int> anagramWords(const DictionaryTrie& trie, const LetterBag& bag, int minLength, int maxLength = 0);
+
+/* The same for the succinct and the disk-backed tries, which have no letter counts to scan;
+ * their words are found by walking the trie with the bag instead. */
+Vector<int> anagramWords(const LoudsTrie& trie, const LetterBag& bag, int minLength, int maxLength = 0);
+Vector<int> anagramWords(const MappedTrie& trie, const LetterBag& bag, int minLength, int maxLength = 0);
+
+/* The same for a tier-limited view of a dictionary: its dictionary's words are scanned as
+ * above, which is quicker than any walk, and the rarer ones dropped. */
+Vector<int> anagramWords(const TierLimitedTrie& trie, const LetterBag& bag, int minLength, int maxLength = 0);
+
+/* Returns true if the uppercase word can be built from the bag. */
+bool fitsInBag(const LetterBag& bag, const std::string& word);
+
+/* Returns the word with the letters the bag runs out of, which blank cubes have to supply, in
+ * lowercase. The later occurrences of a letter are the ones given to blanks. */
+std::string bagSpelling(const LetterBag& bag, const std::string& word);
+
+/* Returns the number of ways to spell the uppercase word with distinct cubes of the bag, in
+ * order: the number of paths spelling it when adjacency is ignored. Counts too large for a
+ * uint64_t are reported as its largest value. */
+uint64_t bagPathCount(const LetterBag& bag, const std::string& word);
+
+#endif // _letterbag_h
@@ -0,0 +1,102 @@
+/* LOUDS TRIE
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * Encodes a DictionaryTrie as the LOUDS bit string declared in loudstrie.h. The source
+ * trie's nodes are visited breadth first, which numbers them in LOUDS order, and each one
+ * writes its degree in unary, its children's letters, and whether it ends a word. */
+
+#include "loudstrie.h"
+#include <algorithm>
+#include "strlib.h"
+using namespace std;
+
+/*************************************************
+ *                  FUNCTIONS                    *
+ ************************************************/
+
+/* The queue holds the source trie's node for every LOUDS node, in LOUDS order, so the
+ * children a node writes are exactly the nodes appended to the queue next. */
+LoudsTrie::LoudsTrie(const DictionaryTrie& trie) : checksum(trie.fingerprint()) {
+    vector<int> queue = {DictionaryTrie::ROOT};
+    labels.push_back(0);
+    louds.push(true);
+    louds.push(false);
+    for(size_t i = 0; i < queue.size(); i++) {
+        int node = queue[i];
+        for(uint32_t letters = trie.childMask(node); letters != 0; letters &= letters - 1) {
+            int letter = __builtin_ctz(letters);
+            queue.push_back(trie.child(node, letter));
+            labels.push_back(letter);
+            louds.push(true);
+        }
+        louds.push(false);
+        terminals.push(trie.wordId(node) != DictionaryTrie::NONE);
+    }
+    louds.index();
+    terminals.index();
+    labels.shrink_to_fit();
+    int width = 1;
+    while((int64_t(1) << width) < trie.wordCount()) {
+        width++;
+    }
+    wordIds.assign(trie.wordCount(), width);
+    terminalRanks.assign(trie.wordCount(), width);
+    int rank = 0;
+    for(size_t i = 0; i < queue.size(); i++) {
+        int id = trie.wordId(queue[i]);
+        if(id != DictionaryTrie::NONE) {
+            wordIds.set(rank, id);
+            terminalRanks.set(id, rank);
+            rank++;
+        }
+    }
+}
+
+LoudsTrie::LoudsTrie(const Lexicon& lexicon) : LoudsTrie(DictionaryTrie(lexicon)) {}
+
+int LoudsTrie::find(const string& prefix) const {
+    int node = ROOT;
+    for(int i = 0; i < (int) prefix.length() && node != NONE; i++) {
+        int letter = letterIndex(prefix[i]);
+        node = letter == -1 ? NONE : child(node, letter);
+    }
+    return node;
+}
+
+bool LoudsTrie::contains(const string& word) const {
+    int node = find(toUpperCase(word));
+    return node != NONE && wordId(node) != NONE;
+}
+
+/* Node c is the one of index c in the LOUDS bits, and its parent is the node whose run of
+ * ones it sits in: one less than the number of zeros before it, since the first zero
+ * closes the run of the virtual node above the root. */
+string LoudsTrie::word(int id) const {
+    string spelling;
+    for(int node = terminals.select1(terminalRanks.get(id)); node != ROOT; ) {
+        spelling += char('A' + labels[node]);
+        node = louds.rank0(louds.select1(node)) - 1;
+    }
+    reverse(spelling.begin(), spelling.end());
+    return spelling;
+}
+
+size_t LoudsTrie::memoryBytes() const {
+    return louds.memoryBytes() + labels.capacity() + terminals.memoryBytes() +
+           (wordIds.words.capacity() + terminalRanks.words.capacity()) * sizeof(uint64_t);
+}
+
+void LoudsTrie::PackedInts::assign(int size, int bits) {
+    width = bits;
+    count = size;
+    words.assign((int64_t(size) * bits + 63) / 64, 0);
+}
+
+void LoudsTrie::PackedInts::set(size_t i, int value) {
+    size_t bit = i * width;
+    words[bit / 64] |= uint64_t(value) << (bit % 64);
+    if(bit % 64 + width > 64) {
+        words[bit / 64 + 1] |= uint64_t(value) >> (64 - bit % 64);
+    }
+}
@@ -0,0 +1,142 @@
+/* LOUDS TRIE
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * A succinct, read-only form of the dictionary for machines where the DictionaryTrie's node
+ * array and word strings take too much memory. The trie's shape is stored as a LOUDS bit
+ * string (level-order unary degree sequence): the nodes are numbered in breadth-first
+ * order, and each node in turn writes a one for every child followed by a zero. That takes
+ * two bits per node, and with rank and select over the bits (see rankselect.h) a node's
+ * children are found without any pointers: the children of node k follow the k-th zero, and
+ * since every earlier one is an earlier node, the first of them is numbered by position.
+ * Each node's edge letter is stored as one byte, and a word's id is kept only for the
+ * nodes that end a word, packed into as few bits as the word count needs.
+ *
+ * The ids are the same as those of the DictionaryTrie it is built from, so solver results,
+ * index files, and anything else keyed by word id work with either. The words themselves are
+ * not stored: word() spells one by walking from its node up to the root.
+ *
+ * It offers the same one-edge-at-a-time operations as DictionaryTrie, so the solver walks it
+ * the same way (see solveBoard in wordsolver.h), but each step costs a select and a scan of
+ * the child letters instead of one array read. "boggletools bench" compares the two. */
+
+#ifndef _loudstrie_h
+#define _loudstrie_h
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "dictionarytrie.h"
+#include "lexicon.h"
+#include "rankselect.h"
+
+class LoudsTrie {
+public:
+    /* Index of the node for the empty prefix. */
+    static const int ROOT = 0;
+
+    /* Returned by child() when there is no edge and by wordId() for non-word nodes. */
+    static const int NONE = -1;
+
+    /* Encodes the given trie; it can be destroyed afterwards. */
+    LoudsTrie(const DictionaryTrie& trie);
+
+    /* Compiles every word of the lexicon made only of the letters A-Z, with the same ids as
+     * a DictionaryTrie of the lexicon would give them. */
+    LoudsTrie(const Lexicon& lexicon);
+
+    /* Returns the node reached from node by the given letter index, or NONE. */
+    int child(int node, int letter) const {
+        size_t start = louds.select0(node) + 1;
+        size_t end = louds.nextZero(start);
+        int first = start - node - 1;
+        for(int c = first; c < first + int(end - start) && labels[c] <= letter; c++) {
+            if(labels[c] == letter) {
+                return c;
+            }
+        }
+        return NONE;
+    }
+
+    /* Returns a mask with bit i set if node has a child for letter index i. */
+    uint32_t childMask(int node) const {
+        size_t start = louds.select0(node) + 1;
+        size_t end = louds.nextZero(start);
+        int first = start - node - 1;
+        uint32_t mask = 0;
+        for(int c = first; c < first + int(end - start); c++) {
+            mask |= uint32_t(1) << labels[c];
+        }
+        return mask;
+    }
+
+    /* Returns the id of the word spelled by the path to node, or NONE. */
+    int wordId(int node) const {
+        return terminals.get(node) ? wordIds.get(terminals.rank1(node)) : NONE;
+    }
+
+    /* Present for the solver's sake; a LOUDS node's children are only located by the select
+     * that child() performs, so there is nothing to fetch ahead of it. */
+    void prefetch(int) const {}
+    void prefetchChildren(int) const {}
+
+    /* Returns the node for the given prefix, or NONE if no word starts with it. */
+    int find(const std::string& prefix) const;
+
+    /* Returns true if the given word is in the dictionary. */
+    bool contains(const std::string& word) const;
+
+    /* Returns the uppercase word with the given id, spelled by walking up from its node. */
+    std::string word(int id) const;
+
+    int nodeCount() const {
+        return labels.size();
+    }
+
+    int wordCount() const {
+        return wordIds.size();
+    }
+
+    /* Returns the same checksum as the DictionaryTrie it was built from. */
+    uint32_t fingerprint() const {
+        return checksum;
+    }
+
+    /* Returns the bytes used by the encoding. */
+    size_t memoryBytes() const;
+
+private:
+    /* Fixed-width unsigned integers packed back to back into 64-bit words. */
+    struct PackedInts {
+        std::vector<uint64_t> words;
+        int width;
+        int count;
+
+        void assign(int size, int bits);
+
+        size_t size() const {
+            return count;
+        }
+
+        int get(size_t i) const {
+            size_t bit = i * width;
+            uint64_t value = words[bit / 64] >> (bit % 64);
+            if(bit % 64 + width > 64) {
+                value |= words[bit / 64 + 1] << (64 - bit % 64);
+            }
+            return value & ((uint64_t(1) << width) - 1);
+        }
+
+        void set(size_t i, int value);
+    };
+
+    RankSelectBits louds;          // "10", then one run of ones and a zero per node
+    std::vector<uint8_t> labels;   // letter index of the edge into each node; unused for ROOT
+    RankSelectBits terminals;      // bit k set if node k ends a word
+    PackedInts wordIds;            // id of the word ending at each terminal, by terminal rank
+    PackedInts terminalRanks;      // terminal rank of the node of each word id
+    uint32_t checksum;
+};
+
+#endif // _loudstrie_h
@@ -0,0 +1,98 @@
+/* MAPPED FILE
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * Implements MappedFile with mmap where it is available, falling back to reading the file. */
+
+#include "mappedfile.h"
+#include <fstream>
+#include <iterator>
+#include "error.h"
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+MappedFile::MappedFile(const string& filename)
+    : bytes(nullptr), length(0), mapped(false), descriptor(-1) {
+#ifndef _WIN32
+    int fd = open(filename.c_str(), O_RDONLY);
+    if(fd < 0) {
+        error("MappedFile: cannot open " + filename);
+    }
+    struct stat info;
+    bool empty = fstat(fd, &info) == 0 && info.st_size == 0;
+    if(!empty && fstat(fd, &info) == 0) {
+        void* address = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if(address != MAP_FAILED) {
+            bytes = static_cast<const char*>(address);
+            length = info.st_size;
+            mapped = true;
+            descriptor = fd;
+        }
+    }
+    if(!mapped) {
+        close(fd);
+    }
+    if(mapped || empty) {
+        return;
+    }
+#endif
+    ifstream input(filename.c_str(), ios::binary);
+    if(!input) {
+        error("MappedFile: cannot open " + filename);
+    }
+    buffer.assign(istreambuf_iterator<char>(input), istreambuf_iterator<char>());
+    bytes = buffer.data();
+    length = buffer.size();
+}
+
+MappedFile::~MappedFile() {
+#ifndef _WIN32
+    if(mapped) {
+        munmap(const_cast<char*>(bytes), length);
+        close(descriptor);
+    }
+#endif
+}
+
+void MappedFile::adviseRandomAccess() const {
+#if !defined(_WIN32) && defined(MADV_RANDOM)
+    if(mapped) {
+        madvise(const_cast<char*>(bytes), length, MADV_RANDOM);
+    }
+#endif
+}
+
+/* Unmapping the pages from this process first lets the system drop the ones it has touched,
+ * which it would otherwise keep as in use. */
+void MappedFile::evictPages() const {
+#ifndef _WIN32
+    if(mapped) {
+        madvise(const_cast<char*>(bytes), length, MADV_DONTNEED);
+#ifdef POSIX_FADV_DONTNEED
+        posix_fadvise(descriptor, 0, length, POSIX_FADV_DONTNEED);
+#endif
+    }
+#endif
+}
+
+size_t MappedFile::residentBytes() const {
+#ifndef _WIN32
+    if(mapped) {
+        size_t pageSize = sysconf(_SC_PAGESIZE);
+        vector<unsigned char> pages((length + pageSize - 1) / pageSize);
+        if(mincore(const_cast<char*>(bytes), length, pages.data()) == 0) {
+            size_t resident = 0;
+            for(unsigned char page : pages) {
+                resident += page & 1;
+            }
+            return resident * pageSize;
+        }
+    }
+#endif
+    return length;
+}
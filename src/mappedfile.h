@@ -0,0 +1,53 @@
+/* MAPPED FILE
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * A read-only view of a whole file. On POSIX systems the file is memory-mapped, so opening
+ * even a very large file is instant and its pages are only read from disk when they are
+ * touched. Elsewhere the file is read into memory instead. */
+
+#ifndef _mappedfile_h
+#define _mappedfile_h
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+class MappedFile {
+public:
+    /* Maps the given file; throws an ErrorException if it cannot be opened. */
+    MappedFile(const std::string& filename);
+    ~MappedFile();
+
+    const char* data() const {
+        return bytes;
+    }
+
+    size_t size() const {
+        return length;
+    }
+
+    /* Tells the system that the file will be read at random, so that touching a page reads
+     * just that page rather than the ones around it too. */
+    void adviseRandomAccess() const;
+
+    /* Asks the system to drop the file's pages from memory, so the next touch of each one
+     * reads it from disk again; a no-op where pages cannot be reclaimed on request. */
+    void evictPages() const;
+
+    /* Returns the bytes of the file currently in memory, in whole pages; the whole file if it
+     * was read rather than mapped. */
+    size_t residentBytes() const;
+
+private:
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* bytes;
+    size_t length;
+    bool mapped;                 // true if bytes must be unmapped rather than freed
+    int descriptor;              // the mapped file, kept open to advise the system about it
+    std::vector<char> buffer;    // holds the file when it could not be mapped
+};
+
+#endif // _mappedfile_h
@@ -0,0 +1,165 @@
+/* MAPPED TRIE
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * Writes and maps the trie files declared in mappedtrie.h. The layout, in native byte order,
+ * is:
+ *     char[8]   magic "BOGGLETR"
+ *     uint32    format version
+ *     uint32    dictionary fingerprint
+ *     uint32    node count N
+ *     uint32    word count W
+ *     uint32    depth count D, one more than the longest word
+ *     uint32    levelStarts[D + 1], the index of the first node of each depth, then N
+ *     ...       zero padding to a multiple of 8 bytes
+ *     uint32    nodes[N][3], each node's child letter mask, first child, and word id
+ *     ...       zero padding to a multiple of 8 bytes
+ *     uint64    offsets[W + 1], where each word starts in the word bytes, then their end
+ *     char      the words, in id order, without separators */
+
+#include "mappedtrie.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include "error.h"
+#include "strlib.h"
+using namespace std;
+
+const char MAPPED_TRIE_MAGIC[8] = {'B', 'O', 'G', 'G', 'L', 'E', 'T', 'R'};
+const uint32_t MAPPED_TRIE_VERSION = 1;
+
+/*************************************************
+ *             PROTOTYPE FUNCTIONS               *
+ ************************************************/
+size_t paddedToWord(size_t bytes);
+
+
+/*************************************************
+ *                  FUNCTIONS                    *
+ ************************************************/
+
+/* The source trie is walked breadth first; every node's children are queued together, so
+ * they get consecutive new indexes and the first of them is the queue's length when they
+ * are added. A depth ends where the queue reaches the first node of the next one. */
+void writeMappedTrie(const DictionaryTrie& trie, const string& filename) {
+    vector<int> queue = {DictionaryTrie::ROOT};
+    vector<uint32_t> records;
+    vector<uint32_t> levelStarts = {0};
+    size_t levelEnd = 1;
+    for(size_t i = 0; i < queue.size(); i++) {
+        if(i == levelEnd) {
+            levelStarts.push_back(i);
+            levelEnd = queue.size();
+        }
+        int node = queue[i];
+        records.push_back(trie.childMask(node));
+        records.push_back(queue.size());
+        records.push_back(trie.wordId(node));
+        for(uint32_t letters = trie.childMask(node); letters != 0; letters &= letters - 1) {
+            queue.push_back(trie.child(node, __builtin_ctz(letters)));
+        }
+    }
+    levelStarts.push_back(queue.size());
+    vector<uint64_t> offsets = {0};
+    for(int id = 0; id < trie.wordCount(); id++) {
+        offsets.push_back(offsets.back() + trie.word(id).length());
+    }
+    ofstream output(filename.c_str(), ios::binary | ios::trunc);
+    if(!output) {
+        error("writeMappedTrie: cannot create " + filename);
+    }
+    uint32_t header[5] = {MAPPED_TRIE_VERSION, trie.fingerprint(), (uint32_t) queue.size(),
+                          (uint32_t) trie.wordCount(), (uint32_t) levelStarts.size() - 1};
+    output.write(MAPPED_TRIE_MAGIC, sizeof(MAPPED_TRIE_MAGIC));
+    output.write(reinterpret_cast<const char*>(header), sizeof(header));
+    output.write(reinterpret_cast<const char*>(levelStarts.data()), levelStarts.size() * sizeof(uint32_t));
+    const char padding[8] = {0};
+    output.write(padding, paddedToWord(output.tellp()) - output.tellp());
+    output.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(uint32_t));
+    output.write(padding, paddedToWord(output.tellp()) - output.tellp());
+    output.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint64_t));
+    for(int id = 0; id < trie.wordCount(); id++) {
+        output.write(trie.word(id).data(), trie.word(id).length());
+    }
+    if(!output) {
+        error("writeMappedTrie: cannot write " + filename);
+    }
+}
+
+/* Each section's position follows from the counts in the header, and the whole file is
+ * checked to be long enough before any of it is used. The Bloom filter is sized by first
+ * counting the keys of the nodes above its depth, which are then read again to add them;
+ * those are the only records read here. */
+MappedTrie::MappedTrie(const string& filename, int bloomDepth, int bloomBitsPerKey)
+    : file(filename), filteredNodes(0) {
+    size_t headerSize = sizeof(MAPPED_TRIE_MAGIC) + 5 * sizeof(uint32_t);
+    if(file.size() < headerSize ||
+       memcmp(file.data(), MAPPED_TRIE_MAGIC, sizeof(MAPPED_TRIE_MAGIC)) != 0) {
+        error("MappedTrie: " + filename + " is not a mapped trie");
+    }
+    uint32_t header[5];
+    memcpy(header, file.data() + sizeof(MAPPED_TRIE_MAGIC), sizeof(header));
+    if(header[0] != MAPPED_TRIE_VERSION) {
+        error("MappedTrie: " + filename + " has unsupported version " + integerToString(header[0]));
+    }
+    checksum = header[1];
+    nodeTotal = header[2];
+    wordTotal = header[3];
+    uint32_t depths = header[4];
+    size_t nodesStart = paddedToWord(headerSize + (size_t(depths) + 1) * sizeof(uint32_t));
+    size_t offsetsStart = paddedToWord(nodesStart + size_t(nodeTotal) * sizeof(Node));
+    size_t wordsStart = offsetsStart + (size_t(wordTotal) + 1) * sizeof(uint64_t);
+    if(file.size() < wordsStart) {
+        error("MappedTrie: " + filename + " is truncated");
+    }
+    nodes = reinterpret_cast<const Node*>(file.data() + nodesStart);
+    wordOffsets = reinterpret_cast<const uint64_t*>(file.data() + offsetsStart);
+    wordBytes = file.data() + wordsStart;
+    if(file.size() < wordsStart + wordOffsets[wordTotal]) {
+        error("MappedTrie: " + filename + " is truncated");
+    }
+    file.adviseRandomAccess();
+    if(bloomDepth > 0) {
+        uint32_t levelStart;
+        memcpy(&levelStart, file.data() + headerSize + min<size_t>(bloomDepth, depths) * sizeof(uint32_t),
+               sizeof(levelStart));
+        size_t keys = 0;
+        for(uint32_t node = 0; node < levelStart; node++) {
+            keys += __builtin_popcount(nodes[node].childMask) + (nodes[node].wordId != NONE);
+        }
+        bloom = PrefixBloomFilter(keys, bloomBitsPerKey);
+        for(uint32_t node = 0; node < levelStart; node++) {
+            for(uint32_t letters = nodes[node].childMask; letters != 0; letters &= letters - 1) {
+                bloom.add(node, __builtin_ctz(letters));
+            }
+            if(nodes[node].wordId != NONE) {
+                bloom.add(node, PrefixBloomFilter::WORD_END);
+            }
+        }
+        filteredNodes = levelStart;
+    }
+}
+
+int MappedTrie::find(const string& prefix) const {
+    int node = ROOT;
+    for(int i = 0; i < (int) prefix.length() && node != NONE; i++) {
+        int letter = letterIndex(prefix[i]);
+        node = letter == -1 ? NONE : child(node, letter);
+    }
+    return node;
+}
+
+bool MappedTrie::contains(const string& word) const {
+    int node = find(toUpperCase(word));
+    return node != NONE && nodes[node].wordId != NONE;
+}
+
+string MappedTrie::word(int id) const {
+    return string(wordBytes + wordOffsets[id], wordOffsets[id + 1] - wordOffsets[id]);
+}
+
+/* Rounds a file position up to a multiple of 8 bytes. */
+size_t paddedToWord(size_t bytes) {
+    return (bytes + 7) / 8 * 8;
+}
@@ -0,0 +1,147 @@
+/* MAPPED TRIE
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * A dictionary trie that stays on disk, for word lists too big to keep resident. The trie is
+ * compiled once into a file by writeMappedTrie, and MappedTrie memory-maps that file (see
+ * mappedfile.h), so a node's record is only read from disk the first time the search
+ * touches its page, and the system may evict it again under memory pressure. The records
+ * are those of DictionaryTrie (child letter mask, first child, word id) but in breadth-first
+ * order, so the shallow nodes every search passes through share a few pages, and the nodes
+ * of each depth are one range of indexes.
+ *
+ * In front of the file sits a PrefixBloomFilter (see prefixbloom.h) over every prefix up to
+ * a chosen length and every word shorter than it. For a node above that depth, childMask()
+ * and wordId() ask the filter first, without touching the node's record: a node the board
+ * cannot continue and that ends no word, which is where most paths of a search die, is never
+ * read at all. The filter can report a letter the node has no child for, so child() may
+ * return NONE for a letter in childMask(), and the solver checks for that.
+ *
+ * The word ids are those of the DictionaryTrie the file was written from, so results can be
+ * compared or stored the same way. */
+
+#ifndef _mappedtrie_h
+#define _mappedtrie_h
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "dictionarytrie.h"
+#include "mappedfile.h"
+#include "prefixbloom.h"
+
+/* Default prefix length covered by the Bloom filter, and its bits per key. */
+const int DEFAULT_BLOOM_DEPTH = 8;
+const int DEFAULT_BLOOM_BITS = 10;
+
+/* Writes the trie to the given file in the format read by MappedTrie. Throws an
+ * ErrorException if the file cannot be written. */
+void writeMappedTrie(const DictionaryTrie& trie, const std::string& filename);
+
+class MappedTrie {
+public:
+    /* Index of the node for the empty prefix. */
+    static const int ROOT = 0;
+
+    /* Returned by child() when there is no edge and by wordId() for non-word nodes. */
+    static const int NONE = -1;
+
+    /* Maps a file written by writeMappedTrie and builds the Bloom filter over the prefixes of
+     * up to bloomDepth letters, reading only the nodes above that depth; a depth of 0 turns
+     * the filter off. Throws an ErrorException if the file is not a mapped trie. */
+    MappedTrie(const std::string& filename, int bloomDepth = DEFAULT_BLOOM_DEPTH,
+               int bloomBitsPerKey = DEFAULT_BLOOM_BITS);
+
+    /* Returns the node reached from node by the given letter index, or NONE. */
+    int child(int node, int letter) const {
+        uint32_t bit = uint32_t(1) << letter;
+        if((nodes[node].childMask & bit) == 0) {
+            return NONE;
+        }
+        return nodes[node].firstChild + __builtin_popcount(nodes[node].childMask & (bit - 1));
+    }
+
+    /* Returns a mask with bit i set if node may have a child for letter index i: exactly the
+     * children below the filter's depth, and a superset of them above it. */
+    uint32_t childMask(int node) const {
+        if(node < filteredNodes) {
+            return bloom.query(node) & CHILD_LETTERS;
+        }
+        return nodes[node].childMask;
+    }
+
+    /* Returns the id of the word spelled by the path to node, or NONE. */
+    int wordId(int node) const {
+        if(node < filteredNodes && (bloom.query(node) & WORD_END_BIT) == 0) {
+            return NONE;
+        }
+        return nodes[node].wordId;
+    }
+
+    /* Present for the solver's sake; prefetching a record would fault its page in on the
+     * search's own thread, so the search is better off not asking. */
+    void prefetch(int) const {}
+    void prefetchChildren(int) const {}
+
+    /* Returns the node for the given prefix, or NONE if no word starts with it. */
+    int find(const std::string& prefix) const;
+
+    /* Returns true if the given word is in the dictionary. */
+    bool contains(const std::string& word) const;
+
+    /* Returns the uppercase word with the given id, read from the file. */
+    std::string word(int id) const;
+
+    int nodeCount() const {
+        return nodeTotal;
+    }
+
+    int wordCount() const {
+        return wordTotal;
+    }
+
+    /* Returns the checksum of the word list, as DictionaryTrie::fingerprint() does. */
+    uint32_t fingerprint() const {
+        return checksum;
+    }
+
+    /* Returns the bytes kept in memory: the Bloom filter. The file's pages are not counted. */
+    size_t residentBytes() const {
+        return bloom.memoryBytes();
+    }
+
+    /* Returns the bytes of the file's pages currently in memory, and drops them; for
+     * measuring how much of the file a search reads. */
+    size_t pagedInBytes() const {
+        return file.residentBytes();
+    }
+
+    void evictPages() const {
+        file.evictPages();
+    }
+
+private:
+    static const uint32_t CHILD_LETTERS = (uint32_t(1) << ALPHABET_SIZE) - 1;
+    static const uint32_t WORD_END_BIT = uint32_t(1) << PrefixBloomFilter::WORD_END;
+
+    struct Node {
+        uint32_t childMask;
+        int32_t firstChild;
+        int32_t wordId;
+    };
+
+    MappedTrie(const MappedTrie&) = delete;
+    MappedTrie& operator=(const MappedTrie&) = delete;
+
+    MappedFile file;
+    const Node* nodes;
+    const uint64_t* wordOffsets;   // word id -> offset into wordBytes, plus the end
+    const char* wordBytes;
+    int nodeTotal;
+    int wordTotal;
+    uint32_t checksum;
+    int filteredNodes;             // nodes whose keys are in the Bloom filter: those above its depth
+    PrefixBloomFilter bloom;
+};
+
+#endif // _mappedtrie_h
@@ -0,0 +1,614 @@
+/* MAX BOARD
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * Implements the branch-and-bound search declared in maxboard.h. A class is held as one
+ * 26-bit letter mask per cell, and its bound is computed on the board's neighbor masks. The
+ * units of a shard are claimed by its threads in blocks, and a block is only recorded as
+ * done once all of its units are; the checkpoint lists the first block not done and the done
+ * blocks after it, so that a resumed search redoes at most the blocks that were in progress.
+ *
+ * The checkpoint is a text file of one keyword per line:
+ *     BOGGLE MAXBOARD 1
+ *     dictionary <fingerprint>
+ *     rules <rule set name>
+ *     board <rows> <cols>
+ *     groups <letter group> ...
+ *     shard <shard> <shards>
+ *     target <target>
+ *     next <first block not done>
+ *     done <block>                (once per done block after next)
+ *     find <score> <letters>      (once per board kept)
+ * It is written to a temporary file first and then renamed over the old one, so a search
+ * stopped while saving leaves the previous checkpoint intact. */
+
+#include "maxboard.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "boardgraph.h"
+#include "error.h"
+#include "grid.h"
+#include "strlib.h"
+#include "wordsolver.h"
+using namespace std;
+
+const string MAX_BOARD_CHECKPOINT_HEADER = "BOGGLE MAXBOARD 1";
+
+/* Units claimed by a thread at a time, and recorded as done together. */
+const long UNIT_BLOCK = 256;
+
+/* The state shared by the threads of one shard's search. The fields after lock are only
+ * touched while holding it; target is also read without it, to prune. A thread that fails
+ * sets stopped, so that the others give up their blocks, and leaves its error in failure. */
+struct MaxBoardSearch {
+    const DictionaryTrie& trie;
+    const GameRules& rules;
+    MaxBoardOptions options;
+    int cellCount;
+    int maxLength;                     // longest word the rules allow, or 0 for no limit
+    vector<uint64_t> neighborMasks;
+    vector<int> points;                // points of each word id, or 0 if the rules forbid it
+    vector<uint32_t> groups;           // letters of each group
+    int letterRanks[ALPHABET_SIZE];    // position of each letter in the groups, to split by
+    vector<int> splitOrder;            // cells by decreasing degree, to break ties when splitting
+    vector<vector<int>> symmetries;    // image of each cell under each rotation and reflection
+    vector<long> places;               // value of a digit on each cell in a unit's number
+    long blockCount;
+    set<long> resumedBlocks;           // blocks already done when the search started
+    atomic<int> target;
+    atomic<long> nextBlock;
+    atomic<bool> stopped;
+    mutex lock;
+    exception_ptr failure;             // first error thrown by a thread, rethrown once all stop
+    long frontier;                     // every block before it is done
+    set<long> doneBlocks;              // done blocks after frontier
+    MaxBoardProgress progress;
+    chrono::steady_clock::time_point lastSave;
+    function<void(const MaxBoardProgress&)> onSave;
+
+    MaxBoardSearch(const DictionaryTrie& trie, const GameRules& rules, const MaxBoardOptions& options)
+        : trie(trie), rules(rules), options(options), stopped(false) {}
+};
+
+/* One thread's board, with letters filled in for each board scored, and its counts since it
+ * last reported them. */
+struct MaxBoardWorker {
+    BoardGraph graph;
+    long classesBounded;
+    long boardsScored;
+};
+
+/*************************************************
+ *             PROTOTYPE FUNCTIONS               *
+ ************************************************/
+void prepareMaxBoardSearch(MaxBoardSearch& search);
+void checkMaxBoardShard(int rows, int cols, int shard, int shards, const string& caller);
+Vector<uint32_t> parseLetterGroups(const string& letterGroups);
+BoardGraph classBoardGraph(int rows, int cols);
+vector<vector<int>> boardSymmetries(int rows, int cols);
+void runMaxBoardThread(MaxBoardSearch& search);
+bool canonicalUnit(const MaxBoardSearch& search, long unit);
+string canonicalBoard(const MaxBoardSearch& search, const string& letters);
+void searchBoardClass(MaxBoardSearch& search, vector<uint32_t>& letters, MaxBoardWorker& worker);
+int64_t boardClassBound(const MaxBoardSearch& search, const vector<uint32_t>& letters, int target);
+int64_t cellClassBound(const MaxBoardSearch& search, const uint32_t* letters, int cell, int node,
+                       uint64_t visited, int length);
+int exactBoardScore(const MaxBoardSearch& search, BoardGraph& graph);
+void recordMaxBoardFind(MaxBoardSearch& search, const string& letters, int score);
+void finishMaxBoardBlock(MaxBoardSearch& search, long block, MaxBoardWorker& worker);
+long blockUnits(const MaxBoardProgress& progress, long block);
+void saveMaxBoardCheckpoint(const MaxBoardSearch& search);
+MaxBoardProgress readMaxBoardState(const string& filename, long& frontier, set<long>& doneBlocks);
+
+
+/*************************************************
+ *                  FUNCTIONS                    *
+ ************************************************/
+
+MaxBoardProgress searchMaxBoard(const DictionaryTrie& trie, const GameRules& rules,
+                                const MaxBoardOptions& options,
+                                const function<void(const MaxBoardProgress&)>& onSave) {
+    MaxBoardSearch search(trie, rules, options);
+    search.onSave = onSave;
+    prepareMaxBoardSearch(search);
+    int threads = max(1, options.threads);
+    if(threads == 1) {
+        runMaxBoardThread(search);
+    } else {
+        vector<thread> workers;
+        for(int i = 0; i < threads; i++) {
+            workers.push_back(thread(runMaxBoardThread, ref(search)));
+        }
+        for(thread& worker : workers) {
+            worker.join();
+        }
+    }
+    if(search.failure) {
+        rethrow_exception(search.failure);
+    }
+    if(!options.checkpointFile.empty()) {
+        saveMaxBoardCheckpoint(search);
+    }
+    return search.progress;
+}
+
+MaxBoardProgress readMaxBoardCheckpoint(const string& filename) {
+    long frontier;
+    set<long> doneBlocks;
+    return readMaxBoardState(filename, frontier, doneBlocks);
+}
+
+/* Checks the options, builds the tables the bound needs, counts the shard's units, and loads
+ * the checkpoint if there is one. The units are numbered in base K, for K letter groups, so
+ * there are K to the power of the cell count of them; that has to fit in a long. */
+void prepareMaxBoardSearch(MaxBoardSearch& search) {
+    const MaxBoardOptions& options = search.options;
+    checkMaxBoardShard(options.rows, options.cols, options.shard, options.shards, "searchMaxBoard");
+    search.cellCount = options.rows * options.cols;
+    Vector<uint32_t> groups = parseLetterGroups(options.letterGroups);
+    search.groups.assign(groups.begin(), groups.end());
+    int rank = 0;
+    for(uint32_t group : search.groups) {
+        for(int letter = 0; letter < ALPHABET_SIZE; letter++) {
+            if((group >> letter) & 1) {
+                search.letterRanks[letter] = rank++;
+            }
+        }
+    }
+    long unitTotal = 1;
+    for(int cell = 0; cell < search.cellCount; cell++) {
+        if(unitTotal > (LONG_MAX / 2) / (long) groups.size()) {
+            error("searchMaxBoard: too many starting classes; use fewer letter groups");
+        }
+        search.places.push_back(unitTotal);
+        unitTotal *= groups.size();
+    }
+    BoardGraph graph = classBoardGraph(options.rows, options.cols);
+    search.neighborMasks.assign(graph.neighborMasks.begin(), graph.neighborMasks.end());
+    for(int cell = 0; cell < search.cellCount; cell++) {
+        search.splitOrder.push_back(cell);
+    }
+    stable_sort(search.splitOrder.begin(), search.splitOrder.end(), [&graph](int a, int b) {
+        return graph.degree(a) > graph.degree(b);
+    });
+    search.symmetries = boardSymmetries(options.rows, options.cols);
+    search.maxLength = search.rules.solveOptions().maxLength;
+    for(int id = 0; id < search.trie.wordCount(); id++) {
+        const string& word = search.trie.word(id);
+        search.points.push_back(search.rules.allows(word) ? search.rules.score(word) : 0);
+    }
+
+    MaxBoardProgress& progress = search.progress;
+    progress.rows = options.rows;
+    progress.cols = options.cols;
+    progress.rulesName = search.rules.name;
+    progress.letterGroups = options.letterGroups;
+    progress.shard = options.shard;
+    progress.shards = options.shards;
+    progress.fingerprint = search.trie.fingerprint();
+    progress.unitCount = (unitTotal - options.shard + options.shards - 1) / options.shards;
+    progress.unitsDone = 0;
+    progress.target = options.target;
+    progress.classesBounded = 0;
+    progress.boardsScored = 0;
+    search.blockCount = (progress.unitCount + UNIT_BLOCK - 1) / UNIT_BLOCK;
+    search.frontier = 0;
+    if(!options.checkpointFile.empty() && ifstream(options.checkpointFile.c_str())) {
+        MaxBoardProgress saved = readMaxBoardState(options.checkpointFile, search.frontier,
+                                                   search.doneBlocks);
+        if(saved.rows != progress.rows || saved.cols != progress.cols ||
+           saved.rulesName != progress.rulesName || saved.letterGroups != progress.letterGroups ||
+           saved.shard != progress.shard || saved.shards != progress.shards ||
+           saved.fingerprint != progress.fingerprint) {
+            error("searchMaxBoard: " + options.checkpointFile + " is the checkpoint of a different search");
+        }
+        progress.target = max(progress.target, saved.target);
+        progress.finds = saved.finds;
+        progress.unitsDone = saved.unitsDone;
+        search.resumedBlocks = search.doneBlocks;
+    }
+    search.target = progress.target;
+    search.nextBlock = search.frontier;
+    search.lastSave = chrono::steady_clock::now();
+}
+
+/* Throws an ErrorException, naming the caller, unless the board has between 1 and
+ * MAX_MASK_CELLS cells and the shard is one of the shards. */
+void checkMaxBoardShard(int rows, int cols, int shard, int shards, const string& caller) {
+    if(rows < 1 || cols < 1 || cols > MAX_MASK_CELLS / rows) {
+        error(caller + ": boards must have between 1 and " + integerToString(MAX_MASK_CELLS) + " cells");
+    }
+    if(shards < 1 || shard < 0 || shard >= shards) {
+        error(caller + ": shard " + integerToString(shard) + " of " + integerToString(shards) +
+              " does not exist");
+    }
+}
+
+/* Returns the letter mask of each space-separated group, checking that every letter is in
+ * exactly one. */
+Vector<uint32_t> parseLetterGroups(const string& letterGroups) {
+    Vector<uint32_t> groups;
+    uint32_t seen = 0;
+    istringstream words(toUpperCase(letterGroups));
+    string group;
+    while(words >> group) {
+        uint32_t letters = 0;
+        for(char ch : group) {
+            int letter = letterIndex(ch);
+            if(letter == -1 || ((seen | letters) >> letter) & 1) {
+                error("searchMaxBoard: letter groups \"" + letterGroups +
+                      "\" repeat a letter or hold a non-letter");
+            }
+            letters |= uint32_t(1) << letter;
+        }
+        seen |= letters;
+        groups.add(letters);
+    }
+    if(seen != (uint32_t(1) << ALPHABET_SIZE) - 1) {
+        error("searchMaxBoard: letter groups \"" + letterGroups + "\" leave out a letter");
+    }
+    return groups;
+}
+
+/* Returns the graph of a rows x cols board, whose letters are filled in by each board scored. */
+BoardGraph classBoardGraph(int rows, int cols) {
+    Grid<char> board(rows, cols);
+    for(int row = 0; row < rows; row++) {
+        for(int col = 0; col < cols; col++) {
+            board[row][col] = 'A';
+        }
+    }
+    return gridBoardGraph(board);
+}
+
+/* Returns, for each way of turning or flipping the board onto itself, the cell each cell is
+ * moved to: the eight symmetries of a square, or the four of a rectangle. */
+vector<vector<int>> boardSymmetries(int rows, int cols) {
+    vector<vector<int>> symmetries;
+    int transforms = rows == cols ? 8 : 4;
+    for(int t = 0; t < transforms; t++) {
+        vector<int> image;
+        for(int r = 0; r < rows; r++) {
+            for(int c = 0; c < cols; c++) {
+                int row = t & 1 ? rows - 1 - r : r;
+                int col = t & 2 ? cols - 1 - c : c;
+                if(t & 4) {
+                    swap(row, col);
+                }
+                image.push_back(row * cols + col);
+            }
+        }
+        symmetries.push_back(image);
+    }
+    return symmetries;
+}
+
+/* Claims blocks of units until none are left or a thread has failed; a block given up part of
+ * the way through is not recorded as done. A unit becomes a class by giving each cell the
+ * group its digit names. An error, such as a checkpoint that cannot be written, cannot leave
+ * a thread, so it is kept in the search for searchMaxBoard to throw after the join. */
+void runMaxBoardThread(MaxBoardSearch& search) {
+    try {
+        MaxBoardWorker worker = {classBoardGraph(search.options.rows, search.options.cols), 0, 0};
+        long groupCount = search.groups.size();
+        vector<uint32_t> letters(search.cellCount);
+        for(long block = search.nextBlock++; block < search.blockCount && !search.stopped;
+            block = search.nextBlock++) {
+            if(search.resumedBlocks.count(block) == 0) {
+                long end = min((block + 1) * UNIT_BLOCK, search.progress.unitCount);
+                for(long index = block * UNIT_BLOCK; index < end && !search.stopped; index++) {
+                    long unit = search.options.shard + index * search.options.shards;
+                    if(!canonicalUnit(search, unit)) {
+                        continue;
+                    }
+                    long digits = unit;
+                    for(int cell = 0; cell < search.cellCount; cell++, digits /= groupCount) {
+                        letters[cell] = search.groups[digits % groupCount];
+                    }
+                    searchBoardClass(search, letters, worker);
+                }
+            }
+            if(!search.stopped) {
+                finishMaxBoardBlock(search, block, worker);
+            }
+        }
+    } catch(...) {
+        lock_guard<mutex> guard(search.lock);
+        if(!search.failure) {
+            search.failure = current_exception();
+        }
+        search.stopped = true;
+    }
+}
+
+/* Returns true if no rotation or reflection of the unit has a lower number. */
+bool canonicalUnit(const MaxBoardSearch& search, long unit) {
+    long groupCount = search.groups.size();
+    for(size_t t = 1; t < search.symmetries.size(); t++) {
+        long image = 0;
+        long digits = unit;
+        for(int cell = 0; cell < search.cellCount; cell++, digits /= groupCount) {
+            image += (digits % groupCount) * search.places[search.symmetries[t][cell]];
+        }
+        if(image < unit) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Returns the alphabetically first of the board's rotations and reflections. A unit that is
+ * its own image holds several of them, so this is how they are kept as one board. */
+string canonicalBoard(const MaxBoardSearch& search, const string& letters) {
+    string best = letters;
+    string image = letters;
+    for(size_t t = 1; t < search.symmetries.size(); t++) {
+        for(int cell = 0; cell < search.cellCount; cell++) {
+            image[search.symmetries[t][cell]] = letters[cell];
+        }
+        best = min(best, image);
+    }
+    return best;
+}
+
+/* Drops the class if its bound is below the target. Otherwise a class of single letters is
+ * scored, and any other is split on its largest cell, whose letters are halved in group
+ * order; of several largest cells, the one with the most neighbors is split first, as it
+ * tightens the bound the most. The letters are restored before returning. */
+void searchBoardClass(MaxBoardSearch& search, vector<uint32_t>& letters, MaxBoardWorker& worker) {
+    worker.classesBounded++;
+    int target = search.target.load(memory_order_relaxed);
+    if(boardClassBound(search, letters, target) < target) {
+        return;
+    }
+    int split = -1;
+    for(int cell : search.splitOrder) {
+        if(__builtin_popcount(letters[cell]) > 1 &&
+           (split == -1 || __builtin_popcount(letters[cell]) > __builtin_popcount(letters[split]))) {
+            split = cell;
+        }
+    }
+    if(split == -1) {
+        for(int cell = 0; cell < search.cellCount; cell++) {
+            worker.graph.letters[cell] = 'A' + __builtin_ctz(letters[cell]);
+        }
+        worker.boardsScored++;
+        int score = exactBoardScore(search, worker.graph);
+        if(score >= target) {
+            string board(worker.graph.letters.begin(), worker.graph.letters.end());
+            recordMaxBoardFind(search, board, score);
+        }
+        return;
+    }
+    uint32_t all = letters[split];
+    vector<int> ranked;
+    for(uint32_t rest = all; rest != 0; rest &= rest - 1) {
+        ranked.push_back(__builtin_ctz(rest));
+    }
+    sort(ranked.begin(), ranked.end(), [&search](int a, int b) {
+        return search.letterRanks[a] < search.letterRanks[b];
+    });
+    uint32_t firstHalf = 0;
+    for(size_t i = 0; i < (ranked.size() + 1) / 2; i++) {
+        firstHalf |= uint32_t(1) << ranked[i];
+    }
+    letters[split] = firstHalf;
+    searchBoardClass(search, letters, worker);
+    letters[split] = all & ~firstHalf;
+    searchBoardClass(search, letters, worker);
+    letters[split] = all;
+}
+
+/* Returns the sum over the starting cells of the best that each can lead to, or, as soon as
+ * that reaches the target, the part summed so far, since the class is split either way. */
+int64_t boardClassBound(const MaxBoardSearch& search, const vector<uint32_t>& letters, int target) {
+    int64_t bound = 0;
+    for(int cell = 0; cell < search.cellCount && bound < target; cell++) {
+        bound += cellClassBound(search, letters.data(), cell, DictionaryTrie::ROOT, 0, 0);
+    }
+    return bound;
+}
+
+/* Returns the most that the paths continuing from node through cell can score: for each of the
+ * cell's letters that extends node, the word it completes plus the bounds of every unused
+ * neighbor, and of those the best. */
+int64_t cellClassBound(const MaxBoardSearch& search, const uint32_t* letters, int cell, int node,
+                       uint64_t visited, int length) {
+    const DictionaryTrie& trie = search.trie;
+    visited |= uint64_t(1) << cell;
+    length++;
+    int64_t best = 0;
+    for(uint32_t choices = letters[cell] & trie.childMask(node); choices != 0; choices &= choices - 1) {
+        int child = trie.child(node, __builtin_ctz(choices));
+        int64_t total = trie.wordId(child) == DictionaryTrie::NONE ? 0 : search.points[trie.wordId(child)];
+        if(trie.childMask(child) != 0 && (search.maxLength == 0 || length < search.maxLength)) {
+            for(uint64_t next = search.neighborMasks[cell] & ~visited; next != 0; next &= next - 1) {
+                total += cellClassBound(search, letters, lowestCell(next), child, visited, length);
+            }
+        }
+        best = max(best, total);
+    }
+    return best;
+}
+
+/* Returns the points of every word on the board under the rules, each word counted once. */
+int exactBoardScore(const MaxBoardSearch& search, BoardGraph& graph) {
+    Map<int, string> wildcardSpellings;
+    Vector<int> wordIds = solveWithRules(graph, search.trie, search.rules, search.rules.solveOptions(),
+                                         wildcardSpellings);
+    int score = 0;
+    for(int id : wordIds) {
+        score += search.rules.score(search.trie.word(id));
+    }
+    return score;
+}
+
+/* Keeps the board and raises the target to its score; the boards kept earlier that now fall
+ * below the target are dropped. */
+void recordMaxBoardFind(MaxBoardSearch& search, const string& letters, int score) {
+    lock_guard<mutex> guard(search.lock);
+    MaxBoardProgress& progress = search.progress;
+    if(score < progress.target) {
+        return;
+    }
+    progress.target = score;
+    search.target = score;
+    string board = canonicalBoard(search, letters);
+    Vector<MaxBoardFind> kept;
+    kept.add(MaxBoardFind {board, score});
+    for(const MaxBoardFind& find : progress.finds) {
+        if(find.score >= score && find.letters != board) {
+            kept.add(find);
+        }
+    }
+    sort(kept.begin(), kept.end(), [](const MaxBoardFind& a, const MaxBoardFind& b) {
+        return a.score != b.score ? a.score > b.score : a.letters < b.letters;
+    });
+    progress.finds = kept;
+}
+
+/* Records the block as done, adds the worker's counts to the progress, and saves the
+ * checkpoint if it is time to. */
+void finishMaxBoardBlock(MaxBoardSearch& search, long block, MaxBoardWorker& worker) {
+    lock_guard<mutex> guard(search.lock);
+    MaxBoardProgress& progress = search.progress;
+    if(search.resumedBlocks.count(block) == 0) {
+        progress.unitsDone += blockUnits(progress, block);
+    }
+    progress.classesBounded += worker.classesBounded;
+    progress.boardsScored += worker.boardsScored;
+    worker.classesBounded = 0;
+    worker.boardsScored = 0;
+    search.doneBlocks.insert(block);
+    while(search.doneBlocks.count(search.frontier) > 0) {
+        search.doneBlocks.erase(search.frontier++);
+    }
+    auto now = chrono::steady_clock::now();
+    if(now - search.lastSave >= chrono::seconds(search.options.checkpointSeconds)) {
+        if(!search.options.checkpointFile.empty()) {
+            saveMaxBoardCheckpoint(search);
+        }
+        search.lastSave = now;
+        if(search.onSave) {
+            search.onSave(progress);
+        }
+    }
+}
+
+/* Returns the number of units in the block; only the last block can have fewer than
+ * UNIT_BLOCK. */
+long blockUnits(const MaxBoardProgress& progress, long block) {
+    return min(UNIT_BLOCK, progress.unitCount - block * UNIT_BLOCK);
+}
+
+void saveMaxBoardCheckpoint(const MaxBoardSearch& search) {
+    const MaxBoardProgress& progress = search.progress;
+    string filename = search.options.checkpointFile;
+    string temporary = filename + ".tmp";
+    ofstream output(temporary.c_str(), ios::trunc);
+    if(!output) {
+        error("searchMaxBoard: cannot create " + temporary);
+    }
+    output << MAX_BOARD_CHECKPOINT_HEADER << endl;
+    output << "dictionary " << progress.fingerprint << endl;
+    output << "rules " << progress.rulesName << endl;
+    output << "board " << progress.rows << " " << progress.cols << endl;
+    output << "groups " << progress.letterGroups << endl;
+    output << "shard " << progress.shard << " " << progress.shards << endl;
+    output << "target " << progress.target << endl;
+    output << "next " << search.frontier << endl;
+    for(long block : search.doneBlocks) {
+        output << "done " << block << endl;
+    }
+    for(const MaxBoardFind& find : progress.finds) {
+        output << "find " << find.score << " " << find.letters << endl;
+    }
+    output.close();
+    if(!output || rename(temporary.c_str(), filename.c_str()) != 0) {
+        error("searchMaxBoard: cannot write " + filename);
+    }
+}
+
+/* Reads a checkpoint, returning the first block not done and the done blocks after it
+ * through frontier and doneBlocks. The units done are counted from them, which takes the
+ * shard's unit count, so that is worked out from the board size and letter groups once they
+ * and the shard have passed the checks searchMaxBoard applies to its options. */
+MaxBoardProgress readMaxBoardState(const string& filename, long& frontier, set<long>& doneBlocks) {
+    ifstream input(filename.c_str());
+    if(!input) {
+        error("readMaxBoardCheckpoint: cannot open " + filename);
+    }
+    string line;
+    if(!getline(input, line) || line != MAX_BOARD_CHECKPOINT_HEADER) {
+        error("readMaxBoardCheckpoint: " + filename + " is not a max board checkpoint");
+    }
+    MaxBoardProgress progress = {0, 0, "", "", 0, 1, 0, 0, 0, 0, Vector<MaxBoardFind>(), 0, 0};
+    frontier = 0;
+    doneBlocks.clear();
+    while(getline(input, line)) {
+        istringstream fields(line);
+        string keyword;
+        if(!(fields >> keyword)) {
+            continue;
+        }
+        if(keyword == "dictionary") {
+            fields >> progress.fingerprint;
+        } else if(keyword == "rules") {
+            getline(fields >> ws, progress.rulesName);
+        } else if(keyword == "board") {
+            fields >> progress.rows >> progress.cols;
+        } else if(keyword == "groups") {
+            getline(fields >> ws, progress.letterGroups);
+        } else if(keyword == "shard") {
+            fields >> progress.shard >> progress.shards;
+        } else if(keyword == "target") {
+            fields >> progress.target;
+        } else if(keyword == "next") {
+            fields >> frontier;
+        } else if(keyword == "done") {
+            long block;
+            fields >> block;
+            doneBlocks.insert(block);
+        } else if(keyword == "find") {
+            MaxBoardFind find;
+            fields >> find.score >> find.letters;
+            progress.finds.add(find);
+        } else {
+            error("readMaxBoardCheckpoint: unknown line \"" + line + "\" in " + filename);
+        }
+        if(fields.fail()) {
+            error("readMaxBoardCheckpoint: malformed line \"" + line + "\" in " + filename);
+        }
+    }
+    checkMaxBoardShard(progress.rows, progress.cols, progress.shard, progress.shards,
+                       "readMaxBoardCheckpoint: " + filename);
+    long unitTotal = 1;
+    long groupCount = parseLetterGroups(progress.letterGroups).size();
+    for(int cell = 0; cell < progress.rows * progress.cols; cell++) {
+        if(unitTotal > (LONG_MAX / 2) / groupCount) {
+            error("readMaxBoardCheckpoint: " + filename + " has too many starting classes");
+        }
+        unitTotal *= groupCount;
+    }
+    progress.unitCount = (unitTotal - progress.shard + progress.shards - 1) / progress.shards;
+    long blockCount = (progress.unitCount + UNIT_BLOCK - 1) / UNIT_BLOCK;
+    if(frontier < 0 || frontier > blockCount ||
+       (!doneBlocks.empty() && (*doneBlocks.begin() <= frontier || *doneBlocks.rbegin() >= blockCount))) {
+        error("readMaxBoardCheckpoint: " + filename + " lists blocks the search does not have");
+    }
+    progress.unitsDone = min(frontier * UNIT_BLOCK, progress.unitCount);
+    for(long block : doneBlocks) {
+        progress.unitsDone += blockUnits(progress, block);
+    }
+    return progress;
+}
@@ -0,0 +1,100 @@
+/* MAX BOARD
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * An exhaustive search for the highest-scoring board of a given size, by branch and bound
+ * over board classes. A class gives each cell a set of letters and stands for every board
+ * that picks one letter per cell. Its upper bound comes from a depth-first search like the
+ * solver's, except that at each cell it takes the best of the cell's letters, separately on
+ * every path, and adds up the words of every path: no board of the class can score more,
+ * since a board has one letter per cell and counts each word once however many paths spell
+ * it. A class whose bound is below the target score is dropped with all of its boards. Any
+ * other class is split in two by halving the letters of its largest cell, until the classes
+ * are single boards, which are solved and scored exactly.
+ *
+ * The search starts from the classes that give each cell one of a few letter groups (see
+ * DEFAULT_LETTER_GROUPS). These are its work units, numbered by reading the cells' group
+ * indexes as the digits of a number, the last cell's being the most significant. Boards that
+ * are rotations or reflections of each other score the same, so a unit is only searched if
+ * none of its images has a lower number. Units are independent, so they are shared among
+ * threads, and a search can be split into shards, one per worker process, by unit number
+ * modulo the number of shards.
+ *
+ * Every board found scoring at least the target is kept, and the target is raised to the best
+ * score found so far, since a board scoring less cannot be the best. Once every unit is done,
+ * the best of the boards kept is the highest-scoring board there is, as long as the starting
+ * target was no higher than its score.
+ *
+ * Progress is saved to a checkpoint file, a few lines of text: the units done, the target
+ * reached, and the boards kept. A search given an existing checkpoint resumes from it, and
+ * the checkpoints of finished worker processes are how their results are collected. */
+
+#ifndef _maxboard_h
+#define _maxboard_h
+
+#include <functional>
+#include <string>
+#include "dictionarytrie.h"
+#include "gamerules.h"
+#include "vector.h"
+
+/* Letter groups of the starting classes, separated by spaces; every letter A-Z must be in
+ * exactly one group. Letters that play alike share a group, so that a class's letters are
+ * interchangeable and its bound stays close to its best board. */
+const std::string DEFAULT_LETTER_GROUPS = "BDFGJQVWXZ AEIOU LNRSY CHKMPT";
+
+struct MaxBoardOptions {
+    int rows;
+    int cols;
+    int target;                  // lowest score to keep a board for, raised as boards are found
+    std::string letterGroups;    // letter groups of the starting classes, as above
+    int threads;
+    int shard;                   // searches the units whose number is shard modulo shards
+    int shards;
+    std::string checkpointFile;  // saves and resumes progress; empty for none
+    int checkpointSeconds;       // least time between saves
+
+    MaxBoardOptions() : rows(4), cols(4), target(1), letterGroups(DEFAULT_LETTER_GROUPS), threads(1),
+                        shard(0), shards(1), checkpointSeconds(60) {}
+};
+
+/* A board kept by the search. */
+struct MaxBoardFind {
+    std::string letters;    // the cells in row-major order, of its alphabetically first image
+    int score;
+};
+
+/* The state of one shard's search, as saved in its checkpoint. */
+struct MaxBoardProgress {
+    int rows;
+    int cols;
+    std::string rulesName;
+    std::string letterGroups;
+    int shard;
+    int shards;
+    uint32_t fingerprint;        // of the dictionary searched
+    long unitCount;              // units in the shard, counting the ones skipped as images
+    long unitsDone;
+    int target;
+    Vector<MaxBoardFind> finds;  // boards scoring at least target, best first
+    long classesBounded;         // by this run only; not saved
+    long boardsScored;           // by this run only; not saved
+
+    bool complete() const {
+        return unitsDone == unitCount;
+    }
+};
+
+/* Searches the units of options.shard, resuming from the checkpoint file if it exists, and
+ * returns the progress made, which is complete unless the search was stopped early. The
+ * progress is passed to onSave, if given, every time the checkpoint is saved. Throws an
+ * ErrorException if the options are invalid or the checkpoint belongs to another search. */
+MaxBoardProgress searchMaxBoard(const DictionaryTrie& trie, const GameRules& rules,
+                                const MaxBoardOptions& options,
+                                const std::function<void(const MaxBoardProgress&)>& onSave = nullptr);
+
+/* Reads a checkpoint saved by searchMaxBoard. Throws an ErrorException if the file cannot be
+ * read or is not a checkpoint. */
+MaxBoardProgress readMaxBoardCheckpoint(const std::string& filename);
+
+#endif // _maxboard_h
@@ -0,0 +1,293 @@
+/* POSTING BITMAP
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * Implements PostingBitmap. A set is stored on disk as a container count followed by each
+ * container's key, type, id count, and then either its sorted array or its 1024-word bitmap,
+ * all in the machine's native byte order. */
+
+#include "postingbitmap.h"
+#include <algorithm>
+#include <cstring>
+#include "error.h"
+using namespace std;
+
+/* Containers holding more ids than this are stored as bitmaps. */
+const int ARRAY_CONTAINER_MAX = 4096;
+
+/* Number of 64-bit words in a bitmap container. */
+const int BITMAP_WORDS = 65536 / 64;
+
+/*************************************************
+ *             PROTOTYPE FUNCTIONS               *
+ ************************************************/
+template <typename T>
+void writeRaw(ostream& output, const T* values, size_t count);
+template <typename T>
+void readRaw(const char*& bytes, const char* end, T* values, size_t count);
+
+
+/*************************************************
+ *                  FUNCTIONS                    *
+ ************************************************/
+
+PostingBitmap::PostingBitmap() : cardinality(0) {
+}
+
+PostingBitmap PostingBitmap::range(int count) {
+    PostingBitmap set;
+    for(int id = 0; id < count; id++) {
+        set.add(id);
+    }
+    return set;
+}
+
+/* A new container is started whenever the high bits change; an array container turns into a
+ * bitmap as soon as it outgrows ARRAY_CONTAINER_MAX. */
+void PostingBitmap::add(int id) {
+    uint16_t key = id >> 16;
+    uint16_t low = id & 0xffff;
+    if(containers.empty() || containers.back().key != key) {
+        containers.push_back(Container {key, 0, {}, {}});
+    }
+    Container& container = containers.back();
+    if(container.isBitmap()) {
+        container.bits[low / 64] |= uint64_t(1) << (low % 64);
+    } else {
+        container.values.push_back(low);
+        if((int) container.values.size() > ARRAY_CONTAINER_MAX) {
+            container.bits.assign(BITMAP_WORDS, 0);
+            for(uint16_t value : container.values) {
+                container.bits[value / 64] |= uint64_t(1) << (value % 64);
+            }
+            container.values.clear();
+            container.values.shrink_to_fit();
+        }
+    }
+    container.count++;
+    cardinality++;
+}
+
+bool PostingBitmap::contains(int id) const {
+    uint16_t key = id >> 16;
+    uint16_t low = id & 0xffff;
+    auto found = lower_bound(containers.begin(), containers.end(), key,
+                             [](const Container& container, uint16_t key) { return container.key < key; });
+    if(found == containers.end() || found->key != key) {
+        return false;
+    }
+    if(found->isBitmap()) {
+        return (found->bits[low / 64] >> (low % 64)) & 1;
+    }
+    return binary_search(found->values.begin(), found->values.end(), low);
+}
+
+Vector<int> PostingBitmap::toVector() const {
+    Vector<int> ids;
+    for(const Container& container : containers) {
+        int high = int(container.key) << 16;
+        if(container.isBitmap()) {
+            for(int word = 0; word < BITMAP_WORDS; word++) {
+                for(uint64_t bits = container.bits[word]; bits != 0; bits &= bits - 1) {
+                    ids.add(high | (word * 64 + __builtin_ctzll(bits)));
+                }
+            }
+        } else {
+            for(uint16_t value : container.values) {
+                ids.add(high | value);
+            }
+        }
+    }
+    return ids;
+}
+
+/* Only containers with the same key can share ids, so the two container lists are merged by
+ * key and each matching pair is intersected on its own. */
+PostingBitmap PostingBitmap::intersect(const PostingBitmap& other) const {
+    PostingBitmap result;
+    size_t i = 0;
+    size_t j = 0;
+    while(i < containers.size() && j < other.containers.size()) {
+        if(containers[i].key < other.containers[j].key) {
+            i++;
+        } else if(containers[i].key > other.containers[j].key) {
+            j++;
+        } else {
+            Container container;
+            andContainers(containers[i], other.containers[j], container);
+            result.append(container);
+            i++;
+            j++;
+        }
+    }
+    return result;
+}
+
+/* Containers of this set with no counterpart in other are kept whole; the rest have the ids
+ * of their counterpart removed. */
+PostingBitmap PostingBitmap::subtract(const PostingBitmap& other) const {
+    PostingBitmap result;
+    size_t j = 0;
+    for(const Container& container : containers) {
+        while(j < other.containers.size() && other.containers[j].key < container.key) {
+            j++;
+        }
+        Container remaining = container;
+        if(j < other.containers.size() && other.containers[j].key == container.key) {
+            andNotContainers(container, other.containers[j], remaining);
+        }
+        result.append(remaining);
+    }
+    return result;
+}
+
+/* Array-array pairs are merged, array-bitmap pairs probe the bitmap for each array value, and
+ * bitmap-bitmap pairs are ANDed a word at a time. */
+void PostingBitmap::andContainers(const Container& a, const Container& b, Container& result) {
+    result.key = a.key;
+    if(a.isBitmap() && b.isBitmap()) {
+        result.bits.resize(BITMAP_WORDS);
+        result.count = 0;
+        for(int word = 0; word < BITMAP_WORDS; word++) {
+            result.bits[word] = a.bits[word] & b.bits[word];
+            result.count += __builtin_popcountll(result.bits[word]);
+        }
+        toArray(result);
+    } else if(a.isBitmap() || b.isBitmap()) {
+        const Container& array = a.isBitmap() ? b : a;
+        const Container& bitmap = a.isBitmap() ? a : b;
+        for(uint16_t value : array.values) {
+            if((bitmap.bits[value / 64] >> (value % 64)) & 1) {
+                result.values.push_back(value);
+            }
+        }
+        result.count = result.values.size();
+    } else {
+        set_intersection(a.values.begin(), a.values.end(), b.values.begin(), b.values.end(),
+                         back_inserter(result.values));
+        result.count = result.values.size();
+    }
+}
+
+/* Computes the ids of a that are not in b, both containers having the same key. */
+void PostingBitmap::andNotContainers(const Container& a, const Container& b, Container& result) {
+    result = Container {a.key, 0, {}, {}};
+    if(a.isBitmap()) {
+        result.bits = a.bits;
+        if(b.isBitmap()) {
+            for(int word = 0; word < BITMAP_WORDS; word++) {
+                result.bits[word] &= ~b.bits[word];
+            }
+        } else {
+            for(uint16_t value : b.values) {
+                result.bits[value / 64] &= ~(uint64_t(1) << (value % 64));
+            }
+        }
+        for(uint64_t word : result.bits) {
+            result.count += __builtin_popcountll(word);
+        }
+        toArray(result);
+    } else if(b.isBitmap()) {
+        for(uint16_t value : a.values) {
+            if(((b.bits[value / 64] >> (value % 64)) & 1) == 0) {
+                result.values.push_back(value);
+            }
+        }
+        result.count = result.values.size();
+    } else {
+        set_difference(a.values.begin(), a.values.end(), b.values.begin(), b.values.end(),
+                       back_inserter(result.values));
+        result.count = result.values.size();
+    }
+}
+
+/* Turns a bitmap container whose count has dropped to ARRAY_CONTAINER_MAX or less back into an
+ * array, so that results stay as compact as sets built with add(). */
+void PostingBitmap::toArray(Container& container) {
+    if(!container.isBitmap() || container.count > ARRAY_CONTAINER_MAX) {
+        return;
+    }
+    container.values.clear();
+    for(int word = 0; word < BITMAP_WORDS; word++) {
+        for(uint64_t bits = container.bits[word]; bits != 0; bits &= bits - 1) {
+            container.values.push_back(word * 64 + __builtin_ctzll(bits));
+        }
+    }
+    container.bits.clear();
+    container.bits.shrink_to_fit();
+}
+
+/* Adds a finished container to the end of the set, dropping it if it is empty. */
+void PostingBitmap::append(Container& container) {
+    if(container.count > 0) {
+        cardinality += container.count;
+        containers.push_back(move(container));
+    }
+}
+
+void PostingBitmap::write(ostream& output) const {
+    uint32_t count = containers.size();
+    writeRaw(output, &count, 1);
+    for(const Container& container : containers) {
+        uint16_t header[2] = {container.key, container.isBitmap()};
+        uint32_t ids = container.count;
+        writeRaw(output, header, 2);
+        writeRaw(output, &ids, 1);
+        if(container.isBitmap()) {
+            writeRaw(output, container.bits.data(), BITMAP_WORDS);
+        } else {
+            writeRaw(output, container.values.data(), container.values.size());
+        }
+    }
+}
+
+/* The counts read are checked against the bytes left before anything is sized by them, so a
+ * corrupt count is reported as truncated data rather than allocated. */
+PostingBitmap PostingBitmap::parse(const char* bytes, size_t length) {
+    const size_t containerHeaderSize = 2 * sizeof(uint16_t) + sizeof(uint32_t);
+    const char* end = bytes + length;
+    PostingBitmap set;
+    uint32_t count;
+    readRaw(bytes, end, &count, 1);
+    if(count > (size_t) (end - bytes) / containerHeaderSize) {
+        error("PostingBitmap: truncated posting data");
+    }
+    set.containers.resize(count);
+    for(Container& container : set.containers) {
+        uint16_t header[2];
+        uint32_t ids;
+        readRaw(bytes, end, header, 2);
+        readRaw(bytes, end, &ids, 1);
+        container.key = header[0];
+        container.count = ids;
+        if(header[1]) {
+            container.bits.resize(BITMAP_WORDS);
+            readRaw(bytes, end, container.bits.data(), BITMAP_WORDS);
+        } else {
+            if(ids > (size_t) (end - bytes) / sizeof(uint16_t)) {
+                error("PostingBitmap: truncated posting data");
+            }
+            container.values.resize(ids);
+            readRaw(bytes, end, container.values.data(), ids);
+        }
+        set.cardinality += ids;
+    }
+    return set;
+}
+
+/* Writes count values as raw bytes. */
+template <typename T>
+void writeRaw(ostream& output, const T* values, size_t count) {
+    output.write(reinterpret_cast<const char*>(values), count * sizeof(T));
+}
+
+/* Copies count values out of the bytes and advances past them; memcpy is used because the
+ * bytes of a mapped file have no particular alignment. */
+template <typename T>
+void readRaw(const char*& bytes, const char* end, T* values, size_t count) {
+    if((size_t) (end - bytes) < count * sizeof(T)) {
+        error("PostingBitmap: truncated posting data");
+    }
+    memcpy(values, bytes, count * sizeof(T));
+    bytes += count * sizeof(T);
+}
@@ -0,0 +1,79 @@
+/* POSTING BITMAP
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * A compressed set of board ids in the style of a roaring bitmap. Ids are grouped by their
+ * high 16 bits, and each group is stored in a container holding the low 16 bits: a sorted
+ * array when the group has at most 4096 ids, or a 65536-bit bitmap when it has more. Sparse
+ * sets (a rare word found on a few boards) stay small, dense sets (a common word found on
+ * most boards) cost at most one bit per board, and intersections and differences work a
+ * container at a time without decompressing anything. */
+
+#ifndef _postingbitmap_h
+#define _postingbitmap_h
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "vector.h"
+
+class PostingBitmap {
+public:
+    /* Creates an empty set. */
+    PostingBitmap();
+
+    /* Returns the set {0, 1, ..., count - 1}. */
+    static PostingBitmap range(int count);
+
+    /* Adds an id to the set. Ids must be added in increasing order. */
+    void add(int id);
+
+    bool contains(int id) const;
+
+    int size() const {
+        return cardinality;
+    }
+
+    bool isEmpty() const {
+        return cardinality == 0;
+    }
+
+    /* Returns the ids in the set in increasing order. */
+    Vector<int> toVector() const;
+
+    /* Returns the ids in both this set and other. */
+    PostingBitmap intersect(const PostingBitmap& other) const;
+
+    /* Returns the ids in this set that are not in other. */
+    PostingBitmap subtract(const PostingBitmap& other) const;
+
+    /* Writes the set in the format read by parse(). */
+    void write(std::ostream& output) const;
+
+    /* Reads a set written by write() from the given bytes, which need not be aligned. Throws
+     * an ErrorException if they do not hold a complete set. */
+    static PostingBitmap parse(const char* bytes, size_t length);
+
+private:
+    struct Container {
+        uint16_t key;                     // high 16 bits shared by the container's ids
+        int count;                        // number of ids in the container
+        std::vector<uint16_t> values;     // sorted low bits, if the container is an array
+        std::vector<uint64_t> bits;       // 1024 words, if the container is a bitmap
+
+        bool isBitmap() const {
+            return !bits.empty();
+        }
+    };
+
+    static void andContainers(const Container& a, const Container& b, Container& result);
+    static void andNotContainers(const Container& a, const Container& b, Container& result);
+    static void toArray(Container& container);
+    void append(Container& container);
+
+    std::vector<Container> containers;
+    int cardinality;
+};
+
+#endif // _postingbitmap_h
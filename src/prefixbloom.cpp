@@ -0,0 +1,58 @@
+/* PREFIX BLOOM
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * Implements the blocked Bloom filter declared in prefixbloom.h. */
+
+#include "prefixbloom.h"
+#include <algorithm>
+using namespace std;
+
+/*************************************************
+ *                  FUNCTIONS                    *
+ ************************************************/
+
+PrefixBloomFilter::PrefixBloomFilter(size_t keys, int bitsPerKey) {
+    size_t bits = keys * bitsPerKey;
+    blocks.assign(max<size_t>(1, (bits + BLOCK_BITS - 1) / BLOCK_BITS), Block());
+}
+
+/* The block is picked by the high half of the node's hash, and the probes are read nine
+ * bits at a time from a second hash: three bits pick one of the block's words and six the
+ * position within it. */
+void PrefixBloomFilter::add(uint32_t node, int symbol) {
+    uint64_t hash = mix(node);
+    Block& block = blocks[blockOf(hash)];
+    uint64_t probes = mix(hash);
+    for(int i = 0; i < PROBES; i++, probes >>= 9) {
+        int position = probes & (BLOCK_BITS - 1);
+        block.words[position / 64] |= uint64_t(1) << ((position + symbol) % 64);
+    }
+}
+
+uint32_t PrefixBloomFilter::query(uint32_t node) const {
+    uint64_t hash = mix(node);
+    const Block& block = blocks[blockOf(hash)];
+    uint64_t probes = mix(hash);
+    uint64_t symbols = ~uint64_t(0);
+    for(int i = 0; i < PROBES; i++, probes >>= 9) {
+        int position = probes & (BLOCK_BITS - 1);
+        int shift = position % 64;
+        uint64_t word = block.words[position / 64];
+        symbols &= shift == 0 ? word : (word >> shift) | (word << (64 - shift));
+    }
+    return symbols & ((uint32_t(1) << (WORD_END + 1)) - 1);
+}
+
+/* Maps the high half of the hash onto the blocks without a division. */
+size_t PrefixBloomFilter::blockOf(uint64_t hash) const {
+    return ((hash >> 32) * blocks.size()) >> 32;
+}
+
+/* The splitmix64 finalizer, which spreads consecutive node numbers over the whole range. */
+uint64_t PrefixBloomFilter::mix(uint64_t value) {
+    uint64_t hash = value + 0x9E3779B97F4A7C15ULL;
+    hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBULL;
+    return hash ^ (hash >> 31);
+}
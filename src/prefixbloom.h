@@ -0,0 +1,63 @@
+/* PREFIX BLOOM
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * A Bloom filter over trie edges, kept in memory in front of a trie that is not. A key is a
+ * node and a symbol: one of the 26 letters, meaning "the node has a child by this letter",
+ * or WORD_END, meaning "the node ends a word". Since a node stands for a prefix, the keys of
+ * the nodes above a given depth are exactly the prefixes up to that length and the words
+ * shorter than it.
+ *
+ * The filter is blocked: all of a node's keys hash into the same 512-bit block, one cache
+ * line. Within it the node gets PROBES positions, and symbol s of the node sets the bit s
+ * places after each of them (wrapping around within its 64-bit word). Rotating each probed
+ * word right by its position lines the node's 27 symbols up in the low bits, so ANDing the
+ * rotated words answers for every symbol at once. Like any Bloom filter it may report a
+ * symbol that was never added, at a rate set by the bits per key (a few percent at 10
+ * bits), but never misses one that was. */
+
+#ifndef _prefixbloom_h
+#define _prefixbloom_h
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class PrefixBloomFilter {
+public:
+    /* The symbol recording that a node ends a word. */
+    static const int WORD_END = 26;
+
+    /* Creates a filter of no bits, which must be replaced by a sized one before it is used. */
+    PrefixBloomFilter() {}
+
+    /* Creates an empty filter sized for the given number of keys. */
+    PrefixBloomFilter(size_t keys, int bitsPerKey);
+
+    /* Adds the key (node, symbol). */
+    void add(uint32_t node, int symbol);
+
+    /* Returns a mask with bit s set for every symbol s whose key (node, s) may have been
+     * added; every added key is among them. */
+    uint32_t query(uint32_t node) const;
+
+    /* Returns the bytes used by the filter's bits. */
+    size_t memoryBytes() const {
+        return blocks.capacity() * sizeof(Block);
+    }
+
+private:
+    static const int PROBES = 6;        // bits set per key, 9 bits of the probe hash each
+    static const int BLOCK_BITS = 512;
+
+    struct alignas(64) Block {
+        uint64_t words[BLOCK_BITS / 64];
+    };
+
+    size_t blockOf(uint64_t hash) const;
+    static uint64_t mix(uint64_t value);
+
+    std::vector<Block> blocks;
+};
+
+#endif // _prefixbloom_h
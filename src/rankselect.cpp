@@ -0,0 +1,130 @@
+/* RANK SELECT
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * Implements the rank and select directories declared in rankselect.h. */
+
+#include "rankselect.h"
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+using namespace std;
+
+/*************************************************
+ *             PROTOTYPE FUNCTIONS               *
+ ************************************************/
+int selectInWord(uint64_t word, int n);
+
+
+/*************************************************
+ *                  FUNCTIONS                    *
+ ************************************************/
+
+RankSelectBits::RankSelectBits() : count(0) {}
+
+void RankSelectBits::push(bool bit) {
+    if(count % 64 == 0) {
+        bits.push_back(0);
+    }
+    if(bit) {
+        bits.back() |= uint64_t(1) << (count % 64);
+    }
+    count++;
+}
+
+/* Sample i names the block holding the one (or zero) of index i * SAMPLE_RATE, so a select
+ * for index n starts at the block of n rounded down to a sampled index and scans forward. */
+void RankSelectBits::index() {
+    size_t blocks = (bits.size() + BLOCK_WORDS - 1) / BLOCK_WORDS;
+    blockRanks.assign(blocks + 1, 0);
+    oneSamples.clear();
+    zeroSamples.clear();
+    size_t ones = 0;
+    for(size_t block = 0; block < blocks; block++) {
+        blockRanks[block] = ones;
+        size_t zeros = block * BLOCK_BITS - ones;
+        for(size_t w = block * BLOCK_WORDS; w < bits.size() && w < (block + 1) * BLOCK_WORDS; w++) {
+            ones += __builtin_popcountll(bits[w]);
+        }
+        size_t end = min((block + 1) * BLOCK_BITS, count);
+        size_t blockZeros = end - block * BLOCK_BITS - (ones - blockRanks[block]);
+        while(oneSamples.size() * SAMPLE_RATE < ones) {
+            oneSamples.push_back(block);
+        }
+        while(zeroSamples.size() * SAMPLE_RATE < zeros + blockZeros) {
+            zeroSamples.push_back(block);
+        }
+    }
+    blockRanks[blocks] = ones;
+    bits.shrink_to_fit();
+}
+
+size_t RankSelectBits::select1(size_t n) const {
+    size_t block = oneSamples[n / SAMPLE_RATE];
+    while(onesBefore(block + 1) <= n) {
+        block++;
+    }
+    size_t remaining = n - onesBefore(block);
+    for(size_t w = block * BLOCK_WORDS; ; w++) {
+        size_t ones = __builtin_popcountll(bits[w]);
+        if(remaining < ones) {
+            return w * 64 + selectInWord(bits[w], remaining);
+        }
+        remaining -= ones;
+    }
+}
+
+/* The bits past size() in the last word are zeros, but they are never selected, since n is
+ * always below the number of real zeros. */
+size_t RankSelectBits::select0(size_t n) const {
+    size_t block = zeroSamples[n / SAMPLE_RATE];
+    while(zerosBefore(block + 1) <= n) {
+        block++;
+    }
+    size_t remaining = n - zerosBefore(block);
+    for(size_t w = block * BLOCK_WORDS; ; w++) {
+        size_t zeros = __builtin_popcountll(~bits[w]);
+        if(remaining < zeros) {
+            return w * 64 + selectInWord(~bits[w], remaining);
+        }
+        remaining -= zeros;
+    }
+}
+
+size_t RankSelectBits::nextZero(size_t position) const {
+    for(size_t w = position / 64; w < bits.size(); w++) {
+        uint64_t zeros = ~bits[w];
+        if(w == position / 64) {
+            zeros &= ~uint64_t(0) << (position % 64);
+        }
+        if(zeros != 0) {
+            return min(w * 64 + __builtin_ctzll(zeros), count);
+        }
+    }
+    return count;
+}
+
+size_t RankSelectBits::memoryBytes() const {
+    return bits.capacity() * sizeof(uint64_t) + (blockRanks.capacity() + oneSamples.capacity() +
+                                                 zeroSamples.capacity()) * sizeof(uint32_t);
+}
+
+/* Returns the position of the set bit of word with the given 0-based index, which must
+ * exist. With BMI2, pdep deposits a single bit at that position; otherwise the word is
+ * narrowed a byte at a time and the last byte is walked. */
+int selectInWord(uint64_t word, int n) {
+#ifdef __BMI2__
+    return __builtin_ctzll(_pdep_u64(uint64_t(1) << n, word));
+#else
+    int shift = 0;
+    for(int ones = __builtin_popcountll(word & 0xff); ones <= n; ones = __builtin_popcountll(word & 0xff)) {
+        n -= ones;
+        word >>= 8;
+        shift += 8;
+    }
+    for(; n > 0; n--) {
+        word &= word - 1;
+    }
+    return shift + __builtin_ctzll(word);
+#endif
+}
@@ -0,0 +1,93 @@
+/* RANK SELECT
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * A static bit vector that answers rank (how many ones come before a position) and select
+ * (where the n-th one or zero is) in constant time, the two operations succinct data
+ * structures such as the LOUDS trie are navigated with. The bits are stored as 64-bit words;
+ * for every block of eight words the number of ones before it is kept in a directory, and
+ * the block holding every 512th one and every 512th zero is sampled, so a rank reads one
+ * directory entry and at most eight words, and a select starts its scan a block or two
+ * from the answer. The directories cost about 7% on top of the bits themselves. */
+
+#ifndef _rankselect_h
+#define _rankselect_h
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class RankSelectBits {
+public:
+    /* Creates an empty bit vector. */
+    RankSelectBits();
+
+    /* Appends a bit. The directories are out of date until index() is called. */
+    void push(bool bit);
+
+    /* Builds the rank and select directories; call it once every bit has been pushed. */
+    void index();
+
+    /* Returns the number of bits. */
+    size_t size() const {
+        return count;
+    }
+
+    /* Returns the bit at position. */
+    bool get(size_t position) const {
+        return (bits[position / 64] >> (position % 64)) & 1;
+    }
+
+    /* Returns the number of ones in positions [0, position). */
+    size_t rank1(size_t position) const {
+        size_t word = position / 64;
+        size_t block = word / BLOCK_WORDS;
+        size_t ones = blockRanks[block];
+        for(size_t w = block * BLOCK_WORDS; w < word; w++) {
+            ones += __builtin_popcountll(bits[w]);
+        }
+        if(position % 64 != 0) {
+            ones += __builtin_popcountll(bits[word] << (64 - position % 64));
+        }
+        return ones;
+    }
+
+    /* Returns the number of zeros in positions [0, position). */
+    size_t rank0(size_t position) const {
+        return position - rank1(position);
+    }
+
+    /* Returns the position of the one with the given 0-based index. */
+    size_t select1(size_t n) const;
+
+    /* Returns the position of the zero with the given 0-based index. */
+    size_t select0(size_t n) const;
+
+    /* Returns the position of the first zero at or after position, or size() if there is
+     * none. */
+    size_t nextZero(size_t position) const;
+
+    /* Returns the bytes used by the bits and their directories. */
+    size_t memoryBytes() const;
+
+private:
+    static const size_t BLOCK_WORDS = 8;
+    static const size_t BLOCK_BITS = BLOCK_WORDS * 64;
+    static const size_t SAMPLE_RATE = 512;
+
+    size_t onesBefore(size_t block) const {
+        return blockRanks[block];
+    }
+
+    size_t zerosBefore(size_t block) const {
+        return block * BLOCK_BITS - blockRanks[block];
+    }
+
+    std::vector<uint64_t> bits;
+    size_t count;
+    std::vector<uint32_t> blockRanks;     // ones before each block, plus a final total
+    std::vector<uint32_t> oneSamples;     // block holding the one of index i * SAMPLE_RATE
+    std::vector<uint32_t> zeroSamples;    // block holding the zero of index i * SAMPLE_RATE
+};
+
+#endif // _rankselect_h
@@ -0,0 +1,61 @@
+/* TLB COUNTER
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * Implements TlbMissCounter with perf_event_open on Linux. */
+
+#include "tlbcounter.h"
+#ifdef __linux__
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/* The counter follows the calling thread on any CPU, and leaves out the kernel so that only
+ * the misses of the search itself are counted. */
+TlbMissCounter::TlbMissCounter() : fd(-1) {
+#ifdef __linux__
+    perf_event_attr attributes;
+    memset(&attributes, 0, sizeof(attributes));
+    attributes.size = sizeof(attributes);
+    attributes.type = PERF_TYPE_HW_CACHE;
+    attributes.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                        (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attributes.disabled = 1;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    fd = syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0);
+#endif
+}
+
+TlbMissCounter::~TlbMissCounter() {
+#ifdef __linux__
+    if(fd >= 0) {
+        close(fd);
+    }
+#endif
+}
+
+void TlbMissCounter::start() {
+#ifdef __linux__
+    if(fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+uint64_t TlbMissCounter::stop() {
+    uint64_t count = 0;
+#ifdef __linux__
+    if(fd >= 0) {
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        if(read(fd, &count, sizeof(count)) != sizeof(count)) {
+            count = 0;
+        }
+    }
+#endif
+    return count;
+}
@@ -0,0 +1,40 @@
+/* TLB COUNTER
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * Counts the data TLB misses of the calling thread with the CPU's performance counters, for
+ * benchmarks of the memory layout. It is only available on Linux, and only when the kernel
+ * lets the process read hardware counters (see perf_event_paranoid); elsewhere it reports
+ * that it is unavailable instead of failing. */
+
+#ifndef _tlbcounter_h
+#define _tlbcounter_h
+
+#include <cstdint>
+
+class TlbMissCounter {
+public:
+    /* Opens the counter, stopped at zero. */
+    TlbMissCounter();
+    ~TlbMissCounter();
+
+    /* Returns true if the counter could be opened. */
+    bool available() const {
+        return fd >= 0;
+    }
+
+    /* Resets the count to zero and starts counting. */
+    void start();
+
+    /* Stops counting and returns the data TLB load misses since start, or 0 if the counter is
+     * unavailable. */
+    uint64_t stop();
+
+private:
+    TlbMissCounter(const TlbMissCounter&) = delete;
+    TlbMissCounter& operator=(const TlbMissCounter&) = delete;
+
+    int fd;    // perf event file descriptor, or -1
+};
+
+#endif // _tlbcounter_h
@@ -0,0 +1,182 @@
+/* WORD INDEX
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * Builds and reads word index files. The layout, in native byte order, is:
+ *     char[8]   magic "BOGGLEIX"
+ *     uint32    format version
+ *     uint32    dictionary fingerprint
+ *     uint32    word count W
+ *     uint32    board count
+ *     uint64    offsets[W + 1], the file position of each word's posting set
+ *     ...       the posting sets, in word id order */
+
+#include "wordindex.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include "corpus.h"
+#include "error.h"
+#include "strlib.h"
+using namespace std;
+
+const char INDEX_MAGIC[8] = {'B', 'O', 'G', 'G', 'L', 'E', 'I', 'X'};
+const uint32_t INDEX_VERSION = 1;
+
+/* Size of the fixed part of the header, before the offsets. */
+const size_t INDEX_HEADER_SIZE = sizeof(INDEX_MAGIC) + 4 * sizeof(uint32_t);
+
+/*************************************************
+ *             PROTOTYPE FUNCTIONS               *
+ ************************************************/
+void writeWordIndex(const vector<PostingBitmap>& postings, uint32_t fingerprint, int boards,
+                    const string& filename, const string& caller);
+void writeUint32(ostream& output, uint32_t value);
+uint32_t readUint32(const char* bytes);
+
+
+/*************************************************
+ *                  FUNCTIONS                    *
+ ************************************************/
+
+/* Boards are solved in increasing id order, so each word's posting set can be built with
+ * add(). */
+void buildWordIndex(const Vector<string>& boards, const DictionaryTrie& trie,
+                    const string& filename, int threads) {
+    vector<PostingBitmap> postings(trie.wordCount());
+    solveCorpus(boards, trie, SolveOptions(), threads,
+                [&](int board, const Vector<int>& wordIds, const Vector<int>&) {
+        for(int id : wordIds) {
+            postings[id].add(board);
+        }
+    });
+    writeWordIndex(postings, trie.fingerprint(), boards.size(), filename, "buildWordIndex");
+}
+
+/* The trie of the added words numbers them in the same order as the new dictionary does,
+ * since both sort their words, so its ids index diff.added. The boards are searched for just
+ * those words, which is quick: the search leaves a path as soon as no added word goes on
+ * with it. */
+DictionaryDiff updateWordIndex(const WordIndex& oldIndex, const DictionaryTrie& oldTrie,
+                               const Vector<string>& boards, const DictionaryTrie& trie,
+                               const string& filename, int threads) {
+    if(oldIndex.fingerprint() != oldTrie.fingerprint()) {
+        error("updateWordIndex: the index was built with a different dictionary");
+    }
+    if(oldIndex.boardCount() != boards.size()) {
+        error("updateWordIndex: the index has " + integerToString(oldIndex.boardCount()) +
+              " boards but the corpus has " + integerToString(boards.size()));
+    }
+    DictionaryDiff diff = diffDictionaries(oldTrie, trie);
+    vector<PostingBitmap> postings(trie.wordCount());
+    for(int id = 0; id < oldTrie.wordCount(); id++) {
+        if(diff.newIds[id] != DictionaryTrie::NONE) {
+            postings[diff.newIds[id]] = oldIndex.boardsWith(id);
+        }
+    }
+    if(!diff.added.isEmpty()) {
+        Vector<string> addedWords;
+        for(int id : diff.added) {
+            addedWords.add(trie.word(id));
+        }
+        DictionaryTrie addedTrie(addedWords);
+        solveCorpus(boards, addedTrie, SolveOptions(), threads,
+                    [&](int board, const Vector<int>& wordIds, const Vector<int>&) {
+            for(int id : wordIds) {
+                postings[diff.added[id]].add(board);
+            }
+        });
+    }
+    writeWordIndex(postings, trie.fingerprint(), boards.size(), filename, "updateWordIndex");
+    return diff;
+}
+
+WordIndex::WordIndex(const string& filename) : file(filename) {
+    if(file.size() < INDEX_HEADER_SIZE || memcmp(file.data(), INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0) {
+        error("WordIndex: " + filename + " is not a word index");
+    }
+    const char* header = file.data() + sizeof(INDEX_MAGIC);
+    if(readUint32(header) != INDEX_VERSION) {
+        error("WordIndex: " + filename + " has unsupported version " + integerToString(readUint32(header)));
+    }
+    dictionaryFingerprint = readUint32(header + 4);
+    words = readUint32(header + 8);
+    boards = readUint32(header + 12);
+    if(file.size() < INDEX_HEADER_SIZE + (words + 1) * sizeof(uint64_t)) {
+        error("WordIndex: " + filename + " is truncated");
+    }
+}
+
+/* The posting set lies between the word's offset and the next word's offset. */
+PostingBitmap WordIndex::boardsWith(int wordId) const {
+    if(wordId < 0 || wordId >= words) {
+        error("WordIndex: word id " + integerToString(wordId) + " is out of range");
+    }
+    uint64_t range[2];
+    memcpy(range, file.data() + INDEX_HEADER_SIZE + wordId * sizeof(uint64_t), sizeof(range));
+    if(range[0] > range[1] || range[1] > file.size()) {
+        error("WordIndex: corrupt offset for word id " + integerToString(wordId));
+    }
+    return PostingBitmap::parse(file.data() + range[0], range[1] - range[0]);
+}
+
+/* The required sets are intersected from smallest to largest, so the running result is never
+ * bigger than the rarest word's set; the excluded sets are then subtracted from it. */
+PostingBitmap WordIndex::query(const Vector<int>& required, const Vector<int>& excluded) const {
+    vector<PostingBitmap> sets;
+    for(int id : required) {
+        sets.push_back(boardsWith(id));
+    }
+    sort(sets.begin(), sets.end(), [](const PostingBitmap& a, const PostingBitmap& b) {
+        return a.size() < b.size();
+    });
+    PostingBitmap result = sets.empty() ? PostingBitmap::range(boards) : sets[0];
+    for(size_t i = 1; i < sets.size() && !result.isEmpty(); i++) {
+        result = result.intersect(sets[i]);
+    }
+    for(int i = 0; i < excluded.size() && !result.isEmpty(); i++) {
+        result = result.subtract(boardsWith(excluded[i]));
+    }
+    return result;
+}
+
+/* Writes an index file of the given posting sets, indexed by word id. The offsets are only
+ * known once the sets are written, so room is left for them and they are filled in at the
+ * end. Errors are reported as coming from caller. */
+void writeWordIndex(const vector<PostingBitmap>& postings, uint32_t fingerprint, int boards,
+                    const string& filename, const string& caller) {
+    ofstream output(filename.c_str(), ios::binary | ios::trunc);
+    if(!output) {
+        error(caller + ": cannot create " + filename);
+    }
+    output.write(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    writeUint32(output, INDEX_VERSION);
+    writeUint32(output, fingerprint);
+    writeUint32(output, postings.size());
+    writeUint32(output, boards);
+    vector<uint64_t> offsets(postings.size() + 1);
+    output.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint64_t));
+    for(size_t id = 0; id < postings.size(); id++) {
+        offsets[id] = output.tellp();
+        postings[id].write(output);
+    }
+    offsets[postings.size()] = output.tellp();
+    output.seekp(INDEX_HEADER_SIZE);
+    output.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint64_t));
+    if(!output) {
+        error(caller + ": cannot write " + filename);
+    }
+}
+
+/* Writes a 32-bit value in native byte order. */
+void writeUint32(ostream& output, uint32_t value) {
+    output.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+/* Reads a 32-bit value in native byte order from possibly unaligned bytes. */
+uint32_t readUint32(const char* bytes) {
+    uint32_t value;
+    memcpy(&value, bytes, sizeof(value));
+    return value;
+}
@@ -0,0 +1,79 @@
+/* WORD INDEX
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * An inverted index over a solved corpus: for every dictionary word id it stores the set of
+ * ids of the boards containing that word, as a PostingBitmap. Queries such as "boards with
+ * both QUIXOTIC and ZEBRA" or "boards with X but not Y" are then answered by intersecting and
+ * subtracting those sets instead of rescanning solver output.
+ *
+ * The index file starts with a header recording the dictionary fingerprint and the word and
+ * board counts, followed by the byte offset of every word's posting set and then the sets
+ * themselves. The file is memory-mapped when opened, so only the postings a query touches
+ * are ever read from disk. */
+
+#ifndef _wordindex_h
+#define _wordindex_h
+
+#include <cstdint>
+#include <string>
+#include "dictionarytrie.h"
+#include "mappedfile.h"
+#include "postingbitmap.h"
+#include "vector.h"
+
+/* Solves every board of the corpus under the classic rules and writes the index of the found
+ * words to the given file, using the given number of threads for the solving. */
+void buildWordIndex(const Vector<std::string>& boards, const DictionaryTrie& trie,
+                    const std::string& filename, int threads);
+
+class WordIndex;
+
+/* Writes the index of the same corpus under a new dictionary, given its index under an old
+ * one, without solving the boards in full again. The posting sets of the words in both
+ * dictionaries are carried over to their new ids, those of the removed words are dropped,
+ * and the boards are only searched for the added words, with a trie of just those. boards
+ * must be the corpus the old index was built from. Returns the differences between the
+ * dictionaries. Throws an ErrorException if the old index was not built with oldTrie or has
+ * a different number of boards. */
+DictionaryDiff updateWordIndex(const WordIndex& oldIndex, const DictionaryTrie& oldTrie,
+                               const Vector<std::string>& boards, const DictionaryTrie& trie,
+                               const std::string& filename, int threads);
+
+class WordIndex {
+public:
+    /* Opens an index file written by buildWordIndex. Throws an ErrorException if the file is
+     * not an index. */
+    WordIndex(const std::string& filename);
+
+    /* Returns the fingerprint of the dictionary the index was built with. */
+    uint32_t fingerprint() const {
+        return dictionaryFingerprint;
+    }
+
+    int wordCount() const {
+        return words;
+    }
+
+    int boardCount() const {
+        return boards;
+    }
+
+    /* Returns the ids of the boards containing the word with the given id. */
+    PostingBitmap boardsWith(int wordId) const;
+
+    /* Returns the ids of the boards containing every required word and none of the excluded
+     * ones. With no required words, every board without an excluded word is returned. */
+    PostingBitmap query(const Vector<int>& required, const Vector<int>& excluded) const;
+
+private:
+    WordIndex(const WordIndex&) = delete;
+    WordIndex& operator=(const WordIndex&) = delete;
+
+    MappedFile file;
+    uint32_t dictionaryFingerprint;
+    int words;
+    int boards;
+};
+
+#endif // _wordindex_h
@@ -0,0 +1,1038 @@
+/* WORD SOLVER
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * Implements the trie-driven word search declared in wordsolver.h. The board is first copied
+ * into a flat layout suited to the search (bitboards for boards of at most 64 cells, plain
+ * adjacency arrays otherwise); then every starting cell is searched depth first, following
+ * only the trie edges that some unused neighboring cell can supply. The depth-first search
+ * runs on an explicit stack of small frames (cell, trie node, moves left) instead of
+ * recursing, so its whole state is one struct.
+ *
+ * The reuse rule is solved level by level instead: every trie node sits at a fixed depth, so
+ * all cells at which a node can be reached are gathered into one cell set before the node is
+ * expanded, and each (cell, node) pair is handled exactly once.
+ *
+ * The letter bag rule hands the board's letters to the anagram search; path counts and
+ * blank spellings only depend on the word and the bag, so they are computed per word. */
+
+#include "wordsolver.h"
+#include <algorithm>
+#include <climits>
+#include <functional>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "letterbag.h"
+#include "strlib.h"
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <immintrin.h>
+#define VECTOR_MOVES 1
+#endif
+using namespace std;
+
+/* Letter code of a blank cube on the search boards; real letters are 0-25 and -1 is none. */
+const int WILDCARD = ALPHABET_SIZE;
+
+/* Most neighbors a cell can have for its moves to be found with one vector operation. */
+const int VECTOR_NEIGHBORS = 8;
+
+/* The board as seen by the bitboard search. Bit c of letterMasks[l] is set if cell c holds
+ * letter index l, and bit c of wildcards is set if cell c is a blank cube. Cells with no
+ * letter (holes, non-letters) are in none of the masks. */
+struct Bitboard {
+    int cellCount;
+    int letters[MAX_MASK_CELLS];
+    uint64_t neighborMasks[MAX_MASK_CELLS];
+    uint64_t letterMasks[ALPHABET_SIZE];
+    uint64_t wildcards;
+    uint64_t vectorCells;    // cells with at most VECTOR_NEIGHBORS neighbors
+    uint8_t neighborLetters[MAX_MASK_CELLS][VECTOR_NEIGHBORS];  // letter codes of a vector cell's
+                                                               // neighbors in cell order, 255 for none
+};
+
+/* The board as seen by the search on boards too big for bitboards. */
+struct AdjacencyBoard {
+    int cellCount;
+    vector<int> letters;
+    vector<int> offsets;
+    vector<int> neighbors;
+};
+
+/* State shared by one thread's search: the dictionary, the options, and the words found so
+ * far. A word is recorded in found the first time a path spells it, which seen marks by id,
+ * so the list grows with the words on the board rather than with the paths, of which a cube
+ * or an adversarial board has millions. Words spelled with blank cubes are kept in
+ * wildcardMasks with the lowest mask of word positions the blanks filled, so that the plain
+ * finds can take precedence and the spelling kept does not depend on the search order. When
+ * paths are counted, paths holds each word id's count. */
+template <typename Trie>
+struct SearchContext {
+    const Trie& trie;
+    int minLength;
+    int maxLength;
+    int prefetchDistance;
+    bool vectorMoves;    // find moves with vectorNeighborMoves where the cell allows
+    bool countPaths;
+    vector<unsigned char> seen;
+    vector<int> found;
+    unordered_map<int, uint64_t> wildcardMasks;
+    vector<int> paths;
+
+    SearchContext(const Trie& trie, const SolveOptions& options)
+        : trie(trie), minLength(options.minLength), maxLength(options.maxLength),
+          prefetchDistance(options.prefetchDistance),
+          vectorMoves(options.vectorMoves), countPaths(options.countPaths),
+          seen(trie.wordCount(), 0), paths(options.countPaths ? trie.wordCount() : 0, 0) {}
+
+    /* Records the word ending at node, if there is one and it is long enough. */
+    void record(int node, int length, uint64_t wildPositions) {
+        int id = trie.wordId(node);
+        if(id != Trie::NONE && length >= minLength) {
+            if(countPaths) {
+                paths[id]++;
+            }
+            if(wildPositions == 0) {
+                if(!seen[id]) {
+                    seen[id] = 1;
+                    found.push_back(id);
+                }
+            } else {
+                auto entry = wildcardMasks.insert({id, wildPositions});
+                if(!entry.second && wildPositions < entry.first->second) {
+                    entry.first->second = wildPositions;
+                }
+            }
+        }
+    }
+};
+
+/* One path of the depth-first search on a bitboard: it ends on cell at trie node node, and
+ * pending holds the unused neighbors not yet tried as its next cell. When the lowest pending
+ * cell is a blank cube, blankLetters holds the letters still to try on it, or 0 before the
+ * first. */
+struct BitboardFrame {
+    uint64_t pending;
+    uint32_t blankLetters;
+    int node;
+    int cell;
+};
+
+/* The state of a depth-first search on a bitboard, kept on an explicit stack rather than in
+ * recursive calls. A path never has more cells than the board, so the stack has a fixed
+ * size, and since the whole search is in this struct it can be stopped between any two
+ * steps and resumed, or have frames handed to another thread. */
+struct BitboardWalk {
+    BitboardFrame frames[MAX_MASK_CELLS];
+    int depth;                 // frames in use, which is the length of the path
+    uint64_t visited;          // cells on the path
+    uint64_t wildPositions;    // word positions filled by blank cubes
+};
+
+/* The same for boards too big for bitboards: the frame's moves are the neighbors from
+ * adjacency index next up to end. */
+struct AdjacencyFrame {
+    int next;
+    int end;
+    uint32_t blankLetters;
+    int node;
+    int cell;
+};
+
+struct AdjacencyWalk {
+    vector<AdjacencyFrame> frames;    // one per board cell
+    int depth;
+    vector<char> visited;
+    uint64_t wildPositions;
+};
+
+/* One level of the reuse search: for every trie node reached, the set of cells it can end on.
+ * Each cell set is `words` 64-bit words stored back to back in bits, so boards of any size
+ * are handled without per-node allocations. When paths are being counted, counts holds, for
+ * every node and cell, the number of walks spelling the node's prefix that end on the cell. */
+struct LevelCellSets {
+    int words;
+    int cells;      // cells per count block, or 0 if paths are not counted
+    vector<int> nodes;
+    vector<uint64_t> bits;
+    vector<uint64_t> counts;
+    unordered_map<int, int> entries;
+
+    LevelCellSets(int words, int cells) : words(words), cells(cells) {}
+
+    /* Returns the cell set of node, adding an empty one if node has not been reached yet. */
+    uint64_t* cellsOf(int node) {
+        auto found = entries.find(node);
+        if(found == entries.end()) {
+            found = entries.insert({node, (int) nodes.size()}).first;
+            nodes.push_back(node);
+            bits.resize(bits.size() + words, 0);
+            counts.resize(counts.size() + cells, 0);
+        }
+        return &bits[found->second * words];
+    }
+
+    /* Returns the walk counts of a node whose cell set exists. */
+    uint64_t* countsOf(int node) {
+        return &counts[entries[node] * cells];
+    }
+};
+
+/*************************************************
+ *             PROTOTYPE FUNCTIONS               *
+ ************************************************/
+template <typename Trie>
+Vector<int> solveWithTrie(const BoardGraph& graph, const Trie& trie, const SolveOptions& options,
+                          Map<int, string>& wildcardSpellings, Vector<int>& pathCounts);
+int cellLetter(char ch);
+bool hasVectorMoves();
+template <typename Trie>
+uint32_t startLetters(const Trie& trie, int letter);
+uint64_t wildcardBit(int position);
+uint64_t saturatingAdd(uint64_t a, uint64_t b);
+string wildcardSpelling(const string& word, uint64_t wildPositions);
+void makeBitboard(const BoardGraph& graph, Bitboard& board);
+void makeAdjacencyBoard(const BoardGraph& graph, AdjacencyBoard& board);
+template <typename Trie>
+void prefetchNeighborMove(const AdjacencyBoard& board, const Trie& trie, int node, int cell);
+template <typename Board, typename Trie>
+Vector<int> solveInThreads(const Board& board, const Trie& trie, const SolveOptions& options,
+                           Map<int, string>& wildcardSpellings, Vector<int>& pathCounts);
+template <typename Board, bool Bounded, typename Trie>
+void solveStarts(const Board& board, SearchContext<Trie>& context, int first, int step);
+template <bool Bounded, typename Trie>
+void searchFrom(const Bitboard& board, SearchContext<Trie>& context, int cell);
+template <bool Bounded, typename Trie>
+void searchFrom(const AdjacencyBoard& board, SearchContext<Trie>& context, int cell);
+template <bool Bounded, typename Trie>
+void bitboardSearch(const Bitboard& board, SearchContext<Trie>& context, BitboardWalk& walk);
+template <bool Bounded, typename Trie>
+void pushBitboardFrame(const Bitboard& board, SearchContext<Trie>& context, BitboardWalk& walk,
+                       int node, int cell);
+template <typename Trie>
+uint64_t bitboardMoves(const Bitboard& board, const SearchContext<Trie>& context, int node, int cell,
+                       uint64_t unused);
+uint64_t vectorNeighborMoves(const uint8_t* neighborLetters, uint32_t childLetters, uint64_t neighbors);
+int nthCell(uint64_t cells, int n);
+template <typename Trie>
+void prefetchCellMove(const Bitboard& board, const Trie& trie, int node, int cell);
+template <bool Bounded, typename Trie>
+void adjacencySearch(const AdjacencyBoard& board, SearchContext<Trie>& context, AdjacencyWalk& walk);
+template <bool Bounded, typename Trie>
+void pushAdjacencyFrame(const AdjacencyBoard& board, SearchContext<Trie>& context, AdjacencyWalk& walk,
+                        int node, int cell);
+template <typename Trie>
+Vector<int> solveWithReuse(const BoardGraph& graph, const Trie& trie, const SolveOptions& options,
+                           Map<int, string>& wildcardSpellings, Vector<int>& pathCounts);
+template <typename Trie>
+Vector<int> solveLetterBag(const BoardGraph& graph, const Trie& trie, const SolveOptions& options,
+                           Map<int, string>& wildcardSpellings, Vector<int>& pathCounts);
+Vector<int> letterBagPath(const BoardGraph& graph, const string& word);
+template <typename Trie>
+void countReuseWalks(const BoardGraph& graph, const Trie& trie, int node,
+                     LevelCellSets& level, LevelCellSets& next);
+Vector<int> reusePath(const BoardGraph& graph, const string& word, bool useWildcards);
+bool simplePath(const BoardGraph& graph, const string& word, bool useWildcards, vector<char>& visited,
+                Vector<int>& path);
+bool pathCellMatches(const BoardGraph& graph, const string& word, bool useWildcards, int cell, int i);
+vector<uint64_t> neighborCellSets(const BoardGraph& graph, int words);
+
+
+/*************************************************
+ *                  FUNCTIONS                    *
+ ************************************************/
+
+Vector<int> solveBoard(const BoardGraph& graph, const DictionaryTrie& trie, const SolveOptions& options) {
+    Map<int, string> wildcardSpellings;
+    return solveBoard(graph, trie, options, wildcardSpellings);
+}
+
+Vector<int> solveBoard(const BoardGraph& graph, const DictionaryTrie& trie,
+                       const SolveOptions& options, Map<int, string>& wildcardSpellings) {
+    Vector<int> pathCounts;
+    return solveBoard(graph, trie, options, wildcardSpellings, pathCounts);
+}
+
+/* A tier limit is applied by searching a TierLimitedTrie over the dictionary instead, unless
+ * the dictionary has no tiers to limit by. */
+Vector<int> solveBoard(const BoardGraph& graph, const DictionaryTrie& trie, const SolveOptions& options,
+                       Map<int, string>& wildcardSpellings, Vector<int>& pathCounts) {
+    if(options.rarestTier < RARE_WORD && trie.hasWordTiers()) {
+        TierLimitedTrie limited(trie, options.rarestTier);
+        return solveWithTrie(graph, limited, options, wildcardSpellings, pathCounts);
+    }
+    return solveWithTrie(graph, trie, options, wildcardSpellings, pathCounts);
+}
+
+Vector<int> solveBoard(const BoardGraph& graph, const LoudsTrie& trie, const SolveOptions& options) {
+    Map<int, string> wildcardSpellings;
+    return solveBoard(graph, trie, options, wildcardSpellings);
+}
+
+Vector<int> solveBoard(const BoardGraph& graph, const LoudsTrie& trie,
+                       const SolveOptions& options, Map<int, string>& wildcardSpellings) {
+    Vector<int> pathCounts;
+    return solveBoard(graph, trie, options, wildcardSpellings, pathCounts);
+}
+
+/* Prefetching is turned off: a LOUDS child is located by the select that the prefetch would
+ * itself have to perform, so there is nothing to overlap. */
+Vector<int> solveBoard(const BoardGraph& graph, const LoudsTrie& trie, const SolveOptions& options,
+                       Map<int, string>& wildcardSpellings, Vector<int>& pathCounts) {
+    SolveOptions loudsOptions = options;
+    loudsOptions.prefetchDistance = 0;
+    return solveWithTrie(graph, trie, loudsOptions, wildcardSpellings, pathCounts);
+}
+
+Vector<int> solveBoard(const BoardGraph& graph, const MappedTrie& trie, const SolveOptions& options) {
+    Map<int, string> wildcardSpellings;
+    return solveBoard(graph, trie, options, wildcardSpellings);
+}
+
+Vector<int> solveBoard(const BoardGraph& graph, const MappedTrie& trie,
+                       const SolveOptions& options, Map<int, string>& wildcardSpellings) {
+    Vector<int> pathCounts;
+    return solveBoard(graph, trie, options, wildcardSpellings, pathCounts);
+}
+
+/* Prefetching is turned off here too: it would fault the records' pages in just the same. */
+Vector<int> solveBoard(const BoardGraph& graph, const MappedTrie& trie, const SolveOptions& options,
+                       Map<int, string>& wildcardSpellings, Vector<int>& pathCounts) {
+    SolveOptions mappedOptions = options;
+    mappedOptions.prefetchDistance = 0;
+    return solveWithTrie(graph, trie, mappedOptions, wildcardSpellings, pathCounts);
+}
+
+/* Every rule is solved by the same code for each kind of trie; the template is only
+ * instantiated for the three above and the tier-limited view. */
+template <typename Trie>
+Vector<int> solveWithTrie(const BoardGraph& graph, const Trie& trie, const SolveOptions& options,
+                          Map<int, string>& wildcardSpellings, Vector<int>& pathCounts) {
+    wildcardSpellings.clear();
+    pathCounts.clear();
+    if(options.rule == NO_IMMEDIATE_REUSE) {
+        return solveWithReuse(graph, trie, options, wildcardSpellings, pathCounts);
+    } else if(options.rule == LETTER_BAG) {
+        return solveLetterBag(graph, trie, options, wildcardSpellings, pathCounts);
+    }
+    if(graph.hasMasks()) {
+        Bitboard board;
+        makeBitboard(graph, board);
+        return solveInThreads(board, trie, options, wildcardSpellings, pathCounts);
+    }
+    AdjacencyBoard board;
+    makeAdjacencyBoard(graph, board);
+    return solveInThreads(board, trie, options, wildcardSpellings, pathCounts);
+}
+
+/* Returns the search board's letter code for the char on a cell. */
+int cellLetter(char ch) {
+    return ch == BOARD_WILDCARD ? WILDCARD : letterIndex(ch);
+}
+
+/* Returns the letters a word can start with on a cell with the given letter code. */
+template <typename Trie>
+uint32_t startLetters(const Trie& trie, int letter) {
+    if(letter == WILDCARD) {
+        return trie.childMask(Trie::ROOT);
+    }
+    return letter == -1 ? 0 : trie.childMask(Trie::ROOT) & (uint32_t(1) << letter);
+}
+
+/* Returns the bit marking a word position as filled by a blank cube. Positions past the
+ * 64th are not tracked, which only affects how such a word's spelling is displayed. */
+uint64_t wildcardBit(int position) {
+    return position < 64 ? uint64_t(1) << position : 0;
+}
+
+/* Returns a + b, or the largest uint64_t if the sum does not fit. */
+uint64_t saturatingAdd(uint64_t a, uint64_t b) {
+    return a + b < a ? UINT64_MAX : a + b;
+}
+
+/* Returns the word with the positions filled by blank cubes in lowercase. */
+string wildcardSpelling(const string& word, uint64_t wildPositions) {
+    string spelling = word;
+    for(; wildPositions != 0; wildPositions &= wildPositions - 1) {
+        int position = __builtin_ctzll(wildPositions);
+        spelling[position] = toLowerCase(spelling[position]);
+    }
+    return spelling;
+}
+
+/* The set of cells reachable from a level's cell set is the union of the cells' neighbor
+ * sets; since no cell neighbors itself, following any of those edges never reuses a cube
+ * twice in a row. Intersecting that union with the cells of each child letter gives the
+ * next level's cell set for that child. Blank cubes are in the cell set of every letter, so
+ * a blank visited more than once in a word may stand for a different letter each time.
+ * Their spellings are recovered afterwards from one path per word. */
+template <typename Trie>
+Vector<int> solveWithReuse(const BoardGraph& graph, const Trie& trie, const SolveOptions& options,
+                           Map<int, string>& wildcardSpellings, Vector<int>& pathCounts) {
+    int words = (graph.cellCount() + 63) / 64;
+    int countCells = options.countPaths ? graph.cellCount() : 0;
+    vector<uint64_t> neighbors = neighborCellSets(graph, words);
+    vector<uint64_t> letterCells(ALPHABET_SIZE * words, 0);
+    LevelCellSets level(words, countCells);
+    bool hasWildcards = false;
+    for(int cell = 0; cell < graph.cellCount(); cell++) {
+        int letter = cellLetter(graph.letters[cell]);
+        uint64_t bit = uint64_t(1) << (cell % 64);
+        for(int other = 0; other < ALPHABET_SIZE; other++) {
+            if(other == letter || letter == WILDCARD) {
+                letterCells[other * words + cell / 64] |= bit;
+            }
+        }
+        for(uint32_t letters = startLetters(trie, letter); letters != 0; letters &= letters - 1) {
+            int node = trie.child(Trie::ROOT, __builtin_ctz(letters));
+            if(node == Trie::NONE) {
+                continue;
+            }
+            level.cellsOf(node)[cell / 64] |= bit;
+            if(options.countPaths) {
+                level.countsOf(node)[cell] = 1;
+            }
+        }
+        hasWildcards = hasWildcards || letter == WILDCARD;
+    }
+    vector<pair<int, uint64_t>> found;
+    vector<uint64_t> reachable(words);
+    int longest = options.maxLength > 0 ? options.maxLength : INT_MAX;
+    for(int length = 1; !level.nodes.empty() && length <= longest; length++) {
+        LevelCellSets next(words, countCells);
+        for(int i = 0; i < (int) level.nodes.size(); i++) {
+            int node = level.nodes[i];
+            const uint64_t* cells = &level.bits[i * words];
+            if(trie.wordId(node) != Trie::NONE && length >= options.minLength) {
+                uint64_t walks = 0;
+                for(int cell = 0; cell < countCells; cell++) {
+                    walks = saturatingAdd(walks, level.counts[i * countCells + cell]);
+                }
+                found.push_back({trie.wordId(node), walks});
+            }
+            fill(reachable.begin(), reachable.end(), 0);
+            for(int w = 0; w < words; w++) {
+                for(uint64_t mask = cells[w]; mask != 0; mask &= mask - 1) {
+                    const uint64_t* adjacent = &neighbors[(w * 64 + lowestCell(mask)) * words];
+                    for(int k = 0; k < words; k++) {
+                        reachable[k] |= adjacent[k];
+                    }
+                }
+            }
+            for(uint32_t letters = trie.childMask(node); letters != 0; letters &= letters - 1) {
+                int letter = __builtin_ctz(letters);
+                uint64_t* childCells = nullptr;
+                for(int k = 0; k < words; k++) {
+                    uint64_t moves = reachable[k] & letterCells[letter * words + k];
+                    if(moves != 0) {
+                        if(childCells == nullptr) {
+                            int child = trie.child(node, letter);
+                            if(child == Trie::NONE) {
+                                break;
+                            }
+                            childCells = next.cellsOf(child);
+                        }
+                        childCells[k] |= moves;
+                    }
+                }
+            }
+            if(options.countPaths) {
+                countReuseWalks(graph, trie, node, level, next);
+            }
+        }
+        level = next;
+    }
+    sort(found.begin(), found.end());
+    Vector<int> ids;
+    for(const pair<int, uint64_t>& word : found) {
+        ids.add(word.first);
+        if(options.countPaths) {
+            pathCounts.add((int) min(word.second, (uint64_t) INT_MAX));
+        }
+    }
+    if(hasWildcards) {
+        for(int id : ids) {
+            Vector<int> path = findReusePath(graph, trie.word(id));
+            uint64_t wildPositions = 0;
+            for(int i = 0; i < path.size(); i++) {
+                if(graph.letters[path[i]] == BOARD_WILDCARD) {
+                    wildPositions |= wildcardBit(i);
+                }
+            }
+            if(wildPositions != 0) {
+                wildcardSpellings.put(id, wildcardSpelling(trie.word(id), wildPositions));
+            }
+        }
+    }
+    return ids;
+}
+
+/* A word found in the bag needs a blank cube exactly when its spelling in the bag differs from
+ * the word itself. */
+template <typename Trie>
+Vector<int> solveLetterBag(const BoardGraph& graph, const Trie& trie, const SolveOptions& options,
+                           Map<int, string>& wildcardSpellings, Vector<int>& pathCounts) {
+    LetterBag bag = letterBag(graph);
+    Vector<int> ids = anagramWords(trie, bag, options.minLength, options.maxLength);
+    for(int id : ids) {
+        if(bag.blanks > 0) {
+            string spelling = bagSpelling(bag, trie.word(id));
+            if(spelling != trie.word(id)) {
+                wildcardSpellings.put(id, spelling);
+            }
+        }
+        if(options.countPaths) {
+            pathCounts.add((int) min(bagPathCount(bag, trie.word(id)), (uint64_t) INT_MAX));
+        }
+    }
+    return ids;
+}
+
+/* Adds the walks of node to the walk counts of its children on the next level: every walk
+ * ending on a cell continues to each neighbor whose letter (any letter, for a blank cube)
+ * is a child of node. The children's cell sets were already created by the set expansion. */
+template <typename Trie>
+void countReuseWalks(const BoardGraph& graph, const Trie& trie, int node,
+                     LevelCellSets& level, LevelCellSets& next) {
+    const uint64_t* counts = level.countsOf(node);
+    uint32_t childLetters = trie.childMask(node);
+    for(int cell = 0; cell < graph.cellCount(); cell++) {
+        if(counts[cell] == 0) {
+            continue;
+        }
+        for(int i = graph.offsets[cell]; i < graph.offsets[cell + 1]; i++) {
+            int nextCell = graph.neighbors[i];
+            int letter = cellLetter(graph.letters[nextCell]);
+            uint32_t letters = letter == WILDCARD ? childLetters
+                             : letter == -1 ? 0 : childLetters & (uint32_t(1) << letter);
+            for(; letters != 0; letters &= letters - 1) {
+                int child = trie.child(node, __builtin_ctz(letters));
+                if(child != Trie::NONE) {
+                    uint64_t* childCounts = next.countsOf(child);
+                    childCounts[nextCell] = saturatingAdd(childCounts[nextCell], counts[cell]);
+                }
+            }
+        }
+    }
+}
+
+/* A path that only uses cubes showing the right letters is preferred over one that needs a
+ * blank cube. */
+Vector<int> findReusePath(const BoardGraph& graph, const string& word) {
+    Vector<int> path = reusePath(graph, word, false);
+    if(path.isEmpty()) {
+        path = reusePath(graph, word, true);
+    }
+    return path;
+}
+
+/* Under the classic rule the path is found by a depth-first search over the cells, first
+ * with exact letters only and then allowing blank cubes. */
+Vector<int> findWordPath(const BoardGraph& graph, const string& word, DiceRule rule) {
+    if(rule == NO_IMMEDIATE_REUSE) {
+        return findReusePath(graph, word);
+    } else if(rule == LETTER_BAG) {
+        return letterBagPath(graph, word);
+    }
+    vector<char> visited(graph.cellCount(), false);
+    Vector<int> path;
+    for(int pass = 0; pass < 2 && !word.empty(); pass++) {
+        for(int cell = 0; cell < graph.cellCount(); cell++) {
+            path.add(cell);
+            if(simplePath(graph, word, pass == 1, visited, path)) {
+                return path;
+            }
+            path.clear();
+        }
+    }
+    return path;
+}
+
+/* Each letter takes the lowest unused cell showing it, or else the lowest unused blank cube.
+ * Since blanks are only taken when a letter has run out, this finds a path whenever one
+ * exists. */
+Vector<int> letterBagPath(const BoardGraph& graph, const string& word) {
+    vector<char> used(graph.cellCount(), false);
+    Vector<int> path;
+    for(char letter : word) {
+        int cell = -1;
+        for(int c = 0; c < graph.cellCount() && cell == -1; c++) {
+            if(!used[c] && graph.letters[c] == letter) {
+                cell = c;
+            }
+        }
+        for(int c = 0; c < graph.cellCount() && cell == -1; c++) {
+            if(!used[c] && graph.letters[c] == BOARD_WILDCARD) {
+                cell = c;
+            }
+        }
+        if(cell == -1) {
+            return Vector<int>();
+        }
+        used[cell] = true;
+        path.add(cell);
+    }
+    return path;
+}
+
+/* path holds one cell, which must match the word's first letter. Extends the path to the
+ * whole word if it can, and otherwise leaves it empty. The search keeps its own stack: path
+ * holds the cells chosen so far, and next[i] the adjacency index of the next neighbor to try
+ * after path[i]. visited is left all false. */
+bool simplePath(const BoardGraph& graph, const string& word, bool useWildcards, vector<char>& visited,
+                Vector<int>& path) {
+    if(!pathCellMatches(graph, word, useWildcards, path[0], 0)) {
+        path.clear();
+        return false;
+    }
+    vector<int> next(1, graph.offsets[path[0]]);
+    visited[path[0]] = true;
+    while(!path.isEmpty() && path.size() < (int) word.length()) {
+        int depth = path.size() - 1;
+        int cell = path[depth];
+        if(next[depth] == graph.offsets[cell + 1]) {
+            visited[cell] = false;
+            path.remove(depth);
+            next.pop_back();
+            continue;
+        }
+        int candidate = graph.neighbors[next[depth]++];
+        if(!visited[candidate] && pathCellMatches(graph, word, useWildcards, candidate, depth + 1)) {
+            visited[candidate] = true;
+            path.add(candidate);
+            next.push_back(graph.offsets[candidate]);
+        }
+    }
+    for(int cell : path) {
+        visited[cell] = false;
+    }
+    return !path.isEmpty();
+}
+
+/* Returns true if cell can spell letter i of the word, with a blank cube only if allowed. */
+bool pathCellMatches(const BoardGraph& graph, const string& word, bool useWildcards, int cell, int i) {
+    return useWildcards ? cellMatches(graph.letters[cell], word[i]) : graph.letters[cell] == word[i];
+}
+
+/* A cell ends the first i + 1 letters of the word if it matches letter i and neighbors a
+ * cell ending the first i letters. One path is then recovered by walking back from a cell
+ * ending the whole word to any neighbor ending the prefix one letter shorter. */
+Vector<int> reusePath(const BoardGraph& graph, const string& word, bool useWildcards) {
+    int words = (graph.cellCount() + 63) / 64;
+    vector<uint64_t> neighbors = neighborCellSets(graph, words);
+    vector<vector<uint64_t>> ends(word.length(), vector<uint64_t>(words, 0));
+    Vector<int> path;
+    for(int i = 0; i < (int) word.length(); i++) {
+        for(int cell = 0; cell < graph.cellCount(); cell++) {
+            bool reached = i == 0;
+            for(int k = 0; k < words && !reached; k++) {
+                reached = (ends[i - 1][k] & neighbors[cell * words + k]) != 0;
+            }
+            bool matches = useWildcards ? cellMatches(graph.letters[cell], word[i])
+                                        : graph.letters[cell] == word[i];
+            if(reached && matches) {
+                ends[i][cell / 64] |= uint64_t(1) << (cell % 64);
+            }
+        }
+    }
+    int cell = -1;
+    for(int i = (int) word.length() - 1; i >= 0; i--) {
+        int previous = cell;
+        cell = -1;
+        for(int c = 0; c < graph.cellCount() && cell == -1; c++) {
+            bool endsHere = (ends[i][c / 64] >> (c % 64)) & 1;
+            bool adjacent = previous == -1 || ((neighbors[previous * words + c / 64] >> (c % 64)) & 1);
+            if(endsHere && adjacent) {
+                cell = c;
+            }
+        }
+        if(cell == -1) {
+            return Vector<int>();
+        }
+        path.insert(0, cell);
+    }
+    return path;
+}
+
+/* Returns every cell's neighbors as a cell set of `words` 64-bit words, back to back. */
+vector<uint64_t> neighborCellSets(const BoardGraph& graph, int words) {
+    vector<uint64_t> sets(graph.cellCount() * words, 0);
+    for(int cell = 0; cell < graph.cellCount(); cell++) {
+        for(int i = graph.offsets[cell]; i < graph.offsets[cell + 1]; i++) {
+            int next = graph.neighbors[i];
+            sets[cell * words + next / 64] |= uint64_t(1) << (next % 64);
+        }
+    }
+    return sets;
+}
+
+/* The search variant, with or without the longest word check, is chosen here once. Each
+ * thread takes every threads-th starting cell and collects its own ids, once each; the lists
+ * are merged, sorted, and deduplicated once all threads have finished. A word found only with
+ * blank cubes keeps the lowest of the threads' masks, so the result does not depend on how
+ * the cells were split between threads. A word's path count is the sum of the threads'. */
+template <typename Board, typename Trie>
+Vector<int> solveInThreads(const Board& board, const Trie& trie, const SolveOptions& options,
+                           Map<int, string>& wildcardSpellings, Vector<int>& pathCounts) {
+    int threads = max(1, min(options.threads, board.cellCount));
+    SolveOptions searchOptions = options;
+    searchOptions.vectorMoves = options.vectorMoves && hasVectorMoves();
+    vector<SearchContext<Trie>> contexts(threads, SearchContext<Trie>(trie, searchOptions));
+    void (*solve)(const Board&, SearchContext<Trie>&, int, int) =
+        options.maxLength > 0 ? solveStarts<Board, true, Trie> : solveStarts<Board, false, Trie>;
+    if(threads == 1) {
+        solve(board, contexts[0], 0, 1);
+    } else {
+        vector<thread> workers;
+        for(int i = 0; i < threads; i++) {
+            workers.push_back(thread(solve, cref(board), ref(contexts[i]), i, threads));
+        }
+        for(thread& worker : workers) {
+            worker.join();
+        }
+    }
+    vector<int> ids;
+    vector<pair<int, uint64_t>> wildcardFound;
+    for(SearchContext<Trie>& context : contexts) {
+        ids.insert(ids.end(), context.found.begin(), context.found.end());
+        wildcardFound.insert(wildcardFound.end(), context.wildcardMasks.begin(),
+                             context.wildcardMasks.end());
+    }
+    sort(ids.begin(), ids.end());
+    ids.erase(unique(ids.begin(), ids.end()), ids.end());
+    sort(wildcardFound.begin(), wildcardFound.end());
+    Vector<int> result;
+    for(int id : ids) {
+        result.add(id);
+    }
+    for(int i = 0; i < (int) wildcardFound.size(); i++) {
+        int id = wildcardFound[i].first;
+        if((i == 0 || wildcardFound[i - 1].first != id) && !binary_search(ids.begin(), ids.end(), id)) {
+            wildcardSpellings.put(id, wildcardSpelling(trie.word(id), wildcardFound[i].second));
+            result.add(id);
+        }
+    }
+    sort(result.begin(), result.end());
+    if(options.countPaths) {
+        for(int id : result) {
+            int count = 0;
+            for(const SearchContext<Trie>& context : contexts) {
+                count += context.paths[id];
+            }
+            pathCounts.add(count);
+        }
+    }
+    return result;
+}
+
+/* Searches from cells first, first + step, first + 2 * step, ... */
+template <typename Board, bool Bounded, typename Trie>
+void solveStarts(const Board& board, SearchContext<Trie>& context, int first, int step) {
+    for(int cell = first; cell < board.cellCount; cell += step) {
+        searchFrom<Bounded>(board, context, cell);
+    }
+}
+
+/* Copies the letters and neighbor masks of a small board into bitboard form. */
+void makeBitboard(const BoardGraph& graph, Bitboard& board) {
+    board.cellCount = graph.cellCount();
+    board.wildcards = 0;
+    board.vectorCells = 0;
+    fill(board.letterMasks, board.letterMasks + ALPHABET_SIZE, 0);
+    for(int cell = 0; cell < board.cellCount; cell++) {
+        board.letters[cell] = cellLetter(graph.letters[cell]);
+        board.neighborMasks[cell] = graph.neighborMasks[cell];
+        if(board.letters[cell] == WILDCARD) {
+            board.wildcards |= uint64_t(1) << cell;
+        } else if(board.letters[cell] != -1) {
+            board.letterMasks[board.letters[cell]] |= uint64_t(1) << cell;
+        }
+    }
+    for(int cell = 0; cell < board.cellCount; cell++) {
+        uint64_t neighbors = board.neighborMasks[cell];
+        if(__builtin_popcountll(neighbors) <= VECTOR_NEIGHBORS) {
+            board.vectorCells |= uint64_t(1) << cell;
+            fill(board.neighborLetters[cell], board.neighborLetters[cell] + VECTOR_NEIGHBORS, 255);
+            for(int i = 0; neighbors != 0; i++, neighbors &= neighbors - 1) {
+                board.neighborLetters[cell][i] = (uint8_t) board.letters[lowestCell(neighbors)];
+            }
+        }
+    }
+}
+
+/* Copies the letters and adjacency lists of a large board into plain arrays. */
+void makeAdjacencyBoard(const BoardGraph& graph, AdjacencyBoard& board) {
+    board.cellCount = graph.cellCount();
+    for(int cell = 0; cell < board.cellCount; cell++) {
+        board.letters.push_back(cellLetter(graph.letters[cell]));
+    }
+    board.offsets.assign(graph.offsets.begin(), graph.offsets.end());
+    board.neighbors.assign(graph.neighbors.begin(), graph.neighbors.end());
+}
+
+/* Starts a search at the given cell for every letter it can show that begins a word. */
+template <bool Bounded, typename Trie>
+void searchFrom(const Bitboard& board, SearchContext<Trie>& context, int cell) {
+    BitboardWalk walk;
+    walk.depth = 0;
+    walk.visited = 0;
+    walk.wildPositions = 0;
+    for(uint32_t letters = startLetters(context.trie, board.letters[cell]); letters != 0; letters &= letters - 1) {
+        int node = context.trie.child(Trie::ROOT, __builtin_ctz(letters));
+        pushBitboardFrame<Bounded>(board, context, walk, node, cell);
+        bitboardSearch<Bounded>(board, context, walk);
+    }
+}
+
+template <bool Bounded, typename Trie>
+void searchFrom(const AdjacencyBoard& board, SearchContext<Trie>& context, int cell) {
+    AdjacencyWalk walk;
+    walk.frames.resize(board.cellCount);
+    walk.depth = 0;
+    walk.visited.assign(board.cellCount, false);
+    walk.wildPositions = 0;
+    for(uint32_t letters = startLetters(context.trie, board.letters[cell]); letters != 0; letters &= letters - 1) {
+        int node = context.trie.child(Trie::ROOT, __builtin_ctz(letters));
+        pushAdjacencyFrame<Bounded>(board, context, walk, node, cell);
+        adjacencySearch<Bounded>(board, context, walk);
+    }
+}
+
+/* Runs the walk until its stack is empty. Each step takes the next move of the top frame: a
+ * pending cell with a letter is removed and searched, while a blank cube stays pending until
+ * every letter it can stand for has been searched. A frame with nothing pending is popped.
+ * While one move is searched, the trie node of the move prefetchDistance places later is
+ * already requested, so that its fetch overlaps the search below the current one. */
+template <bool Bounded, typename Trie>
+void bitboardSearch(const Bitboard& board, SearchContext<Trie>& context, BitboardWalk& walk) {
+    const Trie& trie = context.trie;
+    while(walk.depth > 0) {
+        BitboardFrame& frame = walk.frames[walk.depth - 1];
+        if(frame.pending == 0) {
+            walk.depth--;
+            walk.visited &= ~(uint64_t(1) << frame.cell);
+            walk.wildPositions &= ~wildcardBit(walk.depth);
+            continue;
+        }
+        int nextCell = lowestCell(frame.pending);
+        int letter = board.letters[nextCell];
+        int node = frame.node;
+        if(letter != WILDCARD) {
+            frame.pending &= frame.pending - 1;
+            if(context.prefetchDistance > 0) {
+                prefetchCellMove(board, trie, node, nthCell(frame.pending, context.prefetchDistance - 1));
+            }
+            pushBitboardFrame<Bounded>(board, context, walk, trie.child(node, letter), nextCell);
+        } else {
+            if(frame.blankLetters == 0) {
+                frame.blankLetters = trie.childMask(node);
+            }
+            int blankLetter = __builtin_ctz(frame.blankLetters);
+            frame.blankLetters &= frame.blankLetters - 1;
+            if(frame.blankLetters == 0) {
+                frame.pending &= frame.pending - 1;
+            }
+            pushBitboardFrame<Bounded>(board, context, walk, trie.child(node, blankLetter), nextCell);
+        }
+    }
+}
+
+/* Extends the walk's path to cell, whose letter led to node, records the word there, and
+ * works out which neighbors can continue it. When Bounded, none can once the path is as long
+ * as the longest word to report. A node of NONE is a letter that the trie's childMask only
+ * reported as possible (see MappedTrie), and is ignored. */
+template <bool Bounded, typename Trie>
+void pushBitboardFrame(const Bitboard& board, SearchContext<Trie>& context, BitboardWalk& walk,
+                       int node, int cell) {
+    if(node == Trie::NONE) {
+        return;
+    }
+    int length = walk.depth + 1;
+    walk.visited |= uint64_t(1) << cell;
+    if((board.wildcards >> cell) & 1) {
+        walk.wildPositions |= wildcardBit(walk.depth);
+    }
+    context.record(node, length, walk.wildPositions);
+    BitboardFrame& frame = walk.frames[walk.depth++];
+    frame.node = node;
+    frame.cell = cell;
+    frame.blankLetters = 0;
+    frame.pending = 0;
+    if(!Bounded || length < context.maxLength) {
+        frame.pending = bitboardMoves(board, context, node, cell, board.neighborMasks[cell] & ~walk.visited);
+    }
+    uint64_t ahead = frame.pending;
+    for(int i = 0; i < context.prefetchDistance && ahead != 0; i++, ahead &= ahead - 1) {
+        prefetchCellMove(board, context.trie, node, lowestCell(ahead));
+    }
+}
+
+/* Returns the unused neighbors of cell that can continue a word from node: those whose letter
+ * is a child of node, plus blank cubes if node has any children. On a cell with few enough
+ * neighbors, all of them are checked at once by vectorNeighborMoves when the CPU can.
+ * Otherwise whichever is smaller is walked: the child letters, each matched against the
+ * unused cells with one mask, or the unused cells. */
+template <typename Trie>
+uint64_t bitboardMoves(const Bitboard& board, const SearchContext<Trie>& context, int node, int cell,
+                       uint64_t unused) {
+    uint32_t childLetters = context.trie.childMask(node);
+    if(childLetters == 0) {
+        return 0;
+    }
+    uint64_t moves = unused & board.wildcards;
+    if(context.vectorMoves && ((board.vectorCells >> cell) & 1)) {
+        uint64_t neighbors = vectorNeighborMoves(board.neighborLetters[cell], childLetters,
+                                                 board.neighborMasks[cell]);
+        return moves | (neighbors & unused);
+    }
+    if(__builtin_popcount(childLetters) < __builtin_popcountll(unused)) {
+        for(; childLetters != 0; childLetters &= childLetters - 1) {
+            moves |= unused & board.letterMasks[__builtin_ctz(childLetters)];
+        }
+    } else {
+        for(uint64_t cells = unused & ~board.wildcards; cells != 0; cells &= cells - 1) {
+            int letter = board.letters[lowestCell(cells)];
+            if(letter != -1 && (childLetters & (uint32_t(1) << letter)) != 0) {
+                moves |= cells & -cells;
+            }
+        }
+    }
+    return moves;
+}
+
+/* Returns the neighbors whose letter is in childLetters, given the letter codes of up to eight
+ * neighbors in cell order and the mask of those neighbors. The letters are widened to eight
+ * 32-bit lanes, childLetters is shifted right by each lane's letter, and the low bits are
+ * gathered into one bit per neighbor. Blanks (26) and padding (255) shift past the 26 letter
+ * bits, so they never match. The neighbor bits are then spread onto the neighbor cells, which
+ * are the set bits of neighbors in the same order. */
+#ifdef VECTOR_MOVES
+__attribute__((target("avx2,bmi2")))
+uint64_t vectorNeighborMoves(const uint8_t* neighborLetters, uint32_t childLetters, uint64_t neighbors) {
+    __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(neighborLetters));
+    __m256i letters = _mm256_cvtepu8_epi32(bytes);
+    __m256i present = _mm256_slli_epi32(_mm256_srlv_epi32(_mm256_set1_epi32(childLetters), letters), 31);
+    uint32_t matches = _mm256_movemask_ps(_mm256_castsi256_ps(present));
+    return _pdep_u64(matches, neighbors);
+}
+#else
+uint64_t vectorNeighborMoves(const uint8_t* neighborLetters, uint32_t childLetters, uint64_t neighbors) {
+    uint64_t moves = 0;
+    for(int i = 0; neighbors != 0; i++, neighbors &= neighbors - 1) {
+        if(neighborLetters[i] < ALPHABET_SIZE && ((childLetters >> neighborLetters[i]) & 1) != 0) {
+            moves |= neighbors & -neighbors;
+        }
+    }
+    return moves;
+}
+#endif
+
+/* Returns true if this CPU can run the vector version of vectorNeighborMoves. The check is
+ * made once, the first time it is asked. */
+bool hasVectorMoves() {
+#ifdef VECTOR_MOVES
+    static const bool supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+/* Returns the n-th lowest cell of the mask, counting from 0, or -1 if it has fewer cells. */
+int nthCell(uint64_t cells, int n) {
+    for(int i = 0; i < n && cells != 0; i++) {
+        cells &= cells - 1;
+    }
+    return cells == 0 ? -1 : lowestCell(cells);
+}
+
+/* Prefetches the child of node for the letter on cell, a pending move of node. A blank cube
+ * would need every child, which the search reaches one after another anyway, so it is
+ * skipped, as is a cell of -1 or a letter the trie has no child for. */
+template <typename Trie>
+void prefetchCellMove(const Bitboard& board, const Trie& trie, int node, int cell) {
+    if(cell != -1 && board.letters[cell] != WILDCARD) {
+        int child = trie.child(node, board.letters[cell]);
+        if(child != Trie::NONE) {
+            trie.prefetch(child);
+        }
+    }
+}
+
+/* The same walk as bitboardSearch, trying one neighbor at a time in adjacency order. */
+template <bool Bounded, typename Trie>
+void adjacencySearch(const AdjacencyBoard& board, SearchContext<Trie>& context, AdjacencyWalk& walk) {
+    const Trie& trie = context.trie;
+    while(walk.depth > 0) {
+        AdjacencyFrame& frame = walk.frames[walk.depth - 1];
+        if(frame.next == frame.end) {
+            walk.depth--;
+            walk.visited[frame.cell] = false;
+            walk.wildPositions &= ~wildcardBit(walk.depth);
+            continue;
+        }
+        int nextCell = board.neighbors[frame.next];
+        int letter = board.letters[nextCell];
+        int node = frame.node;
+        uint32_t childLetters = trie.childMask(node);
+        if(letter != WILDCARD) {
+            frame.next++;
+            int ahead = frame.next + context.prefetchDistance - 1;
+            if(context.prefetchDistance > 0 && ahead < frame.end) {
+                prefetchNeighborMove(board, trie, node, board.neighbors[ahead]);
+            }
+            if(!walk.visited[nextCell] && letter != -1 && (childLetters & (uint32_t(1) << letter)) != 0) {
+                pushAdjacencyFrame<Bounded>(board, context, walk, trie.child(node, letter), nextCell);
+            }
+        } else if(walk.visited[nextCell] || childLetters == 0) {
+            frame.next++;
+        } else {
+            if(frame.blankLetters == 0) {
+                frame.blankLetters = childLetters;
+            }
+            int blankLetter = __builtin_ctz(frame.blankLetters);
+            frame.blankLetters &= frame.blankLetters - 1;
+            if(frame.blankLetters == 0) {
+                frame.next++;
+            }
+            pushAdjacencyFrame<Bounded>(board, context, walk, trie.child(node, blankLetter), nextCell);
+        }
+    }
+}
+
+template <bool Bounded, typename Trie>
+void pushAdjacencyFrame(const AdjacencyBoard& board, SearchContext<Trie>& context, AdjacencyWalk& walk,
+                        int node, int cell) {
+    if(node == Trie::NONE) {
+        return;
+    }
+    int length = walk.depth + 1;
+    walk.visited[cell] = true;
+    if(board.letters[cell] == WILDCARD) {
+        walk.wildPositions |= wildcardBit(walk.depth);
+    }
+    context.record(node, length, walk.wildPositions);
+    AdjacencyFrame& frame = walk.frames[walk.depth++];
+    frame.node = node;
+    frame.cell = cell;
+    frame.blankLetters = 0;
+    frame.next = board.offsets[cell];
+    frame.end = Bounded && length >= context.maxLength ? frame.next : board.offsets[cell + 1];
+    for(int i = frame.next; i < frame.end && i < frame.next + context.prefetchDistance; i++) {
+        prefetchNeighborMove(board, context.trie, node, board.neighbors[i]);
+    }
+}
+
+/* Prefetches the child of node for the letter on cell, if node has one; blanks are skipped.
+ * childMask is not enough to go by, since a tier-limited trie reports children it prunes. */
+template <typename Trie>
+void prefetchNeighborMove(const AdjacencyBoard& board, const Trie& trie, int node, int cell) {
+    int letter = board.letters[cell];
+    if(letter >= 0 && letter < WILDCARD) {
+        int child = trie.child(node, letter);
+        if(child != Trie::NONE) {
+            trie.prefetch(child);
+        }
+    }
+}
@@ -0,0 +1,132 @@
+/* WORD SOLVER
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * The engine behind the CPU word search. It walks a BoardGraph and a DictionaryTrie together,
+ * so each step of the search follows one trie edge instead of rechecking a prefix string.
+ * Boards of at most 64 cells are searched with bitboards: the used cells, the neighbors of
+ * each cell, and the cells holding each letter are all 64-bit masks, so the unused neighbors
+ * that continue a word are found with a couple of AND operations. On CPUs with AVX2, a cell's
+ * up to eight neighbor letters are instead checked against the trie node's children in one
+ * vector operation, which yields the mask of moves directly. Larger boards fall back to
+ * the CSR adjacency lists. The starting cells can be split across several threads.
+ *
+ * A blank cube (BOARD_WILDCARD) matches whichever letters the current trie node actually has
+ * children for, so a board with k blanks costs one search rather than 26^k.
+ *
+ * Under the NO_IMMEDIATE_REUSE rule a word may visit a cube more than once, so the only state
+ * that matters is the pair (cell, trie node). Those words are found by a breadth-first search
+ * over that product graph, which takes polynomial rather than exponential time. Under that
+ * rule a blank cube stands for a letter each time it is used, not once per word, since
+ * remembering its letter would bring the exponential state back.
+ *
+ * The solver can also count the distinct cell paths spelling each found word. The depth-first
+ * search already walks every path once, sharing each prefix among all the words that extend
+ * it, so counting costs nothing extra there; under the reuse rule the counts are carried
+ * level by level alongside the cell sets.
+ *
+ * Under the LETTER_BAG rule adjacency is ignored and the board is reduced to its multiset of
+ * letters; those words are found by the anagram search in letterbag.h.
+ *
+ * The depth-first search is bound by the latency of fetching trie nodes, each of which depends
+ * on the one before. While it searches below one move, it prefetches the child node of a move
+ * a few places further along the same loop; the distance is an option, so that it can be
+ * tuned per host with "boggletools bench".
+ *
+ * The search is written once for any trie offering DictionaryTrie's edge operations, and is
+ * compiled for it, the succinct LoudsTrie (see loudstrie.h), and the disk-backed MappedTrie
+ * (see mappedtrie.h). A trie's childMask may report letters it has no child for, as the
+ * MappedTrie's Bloom filter can, so a child of NONE is skipped wherever one is taken.
+ *
+ * A search can be limited to the words no rarer than a given tier (see WordTier in
+ * dictionarytrie.h), for computer opponents that should not find everything. The limit
+ * prunes the trie itself, through a TierLimitedTrie, so the subtrees holding only rarer words
+ * are never searched and a limited solve costs less than a full one.
+ *
+ * With a longest word length set, the search stops descending once a path reaches it. The
+ * depth-first search is compiled in two variants, with and without that check, so boards
+ * solved without a limit pay nothing for it. */
+
+#ifndef _wordsolver_h
+#define _wordsolver_h
+
+#include <string>
+#include "boardgraph.h"
+#include "boggleconstants.h"
+#include "dictionarytrie.h"
+#include "loudstrie.h"
+#include "map.h"
+#include "mappedtrie.h"
+#include "vector.h"
+
+/* Prefetch distance of the depth-first search; see SolveOptions. */
+const int DEFAULT_PREFETCH_DISTANCE = 2;
+
+/* Whether a word may use the same cube more than once. */
+enum DiceRule {
+    USE_EACH_CUBE_ONCE,    // classic Boggle
+    NO_IMMEDIATE_REUSE,    // a cube may be reused, just not twice in a row
+    LETTER_BAG             // any cubes, in any order, each used once (anagrams)
+};
+
+struct SolveOptions {
+    int minLength;   // shortest word to report
+    int maxLength;   // longest word to report, or 0 for no limit
+    int threads;     // number of threads to split the starting cells across
+    DiceRule rule;
+    bool countPaths; // also count the paths spelling each word
+    int prefetchDistance;  // trie children requested ahead of the one being searched, or 0
+    bool vectorMoves;      // check a cell's neighbors with one vector operation, if the CPU can
+    WordTier rarestTier;   // rarest words to report; only a DictionaryTrie has tiers to limit
+
+    SolveOptions() : minLength(MIN_WORD_LENGTH), maxLength(0), threads(1), rule(USE_EACH_CUBE_ONCE),
+                     countPaths(false), prefetchDistance(DEFAULT_PREFETCH_DISTANCE), vectorMoves(true),
+                     rarestTier(RARE_WORD) {}
+};
+
+/* Returns the ids of every dictionary word that can be formed on the board, in increasing
+ * order and without duplicates. */
+Vector<int> solveBoard(const BoardGraph& graph, const DictionaryTrie& trie,
+                       const SolveOptions& options = SolveOptions());
+
+/* Solves the board as above. wildcardSpellings is cleared, and every found word that can only
+ * be formed with the help of a blank cube is then added to it, mapped to the word as it was
+ * spelled on the board: the letters the blanks stood for are shown in lowercase. */
+Vector<int> solveBoard(const BoardGraph& graph, const DictionaryTrie& trie,
+                       const SolveOptions& options, Map<int, std::string>& wildcardSpellings);
+
+/* Solves the board as above. If options.countPaths is set, pathCounts[i] is then the number of
+ * distinct cell paths spelling the i-th returned word, counting those through blank cubes;
+ * otherwise pathCounts is left empty. Under the reuse rule, where a word may revisit cells,
+ * counts too large for an int are reported as INT_MAX. */
+Vector<int> solveBoard(const BoardGraph& graph, const DictionaryTrie& trie, const SolveOptions& options,
+                       Map<int, std::string>& wildcardSpellings, Vector<int>& pathCounts);
+
+/* The same three searches over the succinct trie, for machines short on memory. They find the
+ * same word ids as with the DictionaryTrie the LoudsTrie was built from, only more slowly. */
+Vector<int> solveBoard(const BoardGraph& graph, const LoudsTrie& trie,
+                       const SolveOptions& options = SolveOptions());
+Vector<int> solveBoard(const BoardGraph& graph, const LoudsTrie& trie,
+                       const SolveOptions& options, Map<int, std::string>& wildcardSpellings);
+Vector<int> solveBoard(const BoardGraph& graph, const LoudsTrie& trie, const SolveOptions& options,
+                       Map<int, std::string>& wildcardSpellings, Vector<int>& pathCounts);
+
+/* The same three searches over a trie kept on disk, for dictionaries too big for memory. */
+Vector<int> solveBoard(const BoardGraph& graph, const MappedTrie& trie,
+                       const SolveOptions& options = SolveOptions());
+Vector<int> solveBoard(const BoardGraph& graph, const MappedTrie& trie,
+                       const SolveOptions& options, Map<int, std::string>& wildcardSpellings);
+Vector<int> solveBoard(const BoardGraph& graph, const MappedTrie& trie, const SolveOptions& options,
+                       Map<int, std::string>& wildcardSpellings, Vector<int>& pathCounts);
+
+/* Returns the cells of one path spelling word under the NO_IMMEDIATE_REUSE rule, or an empty
+ * Vector if the word cannot be formed that way. Blank cubes are only used if they have to be. */
+Vector<int> findReusePath(const BoardGraph& graph, const std::string& word);
+
+/* Returns the cells of one path spelling the uppercase word under the given rule, or an empty
+ * Vector if the word cannot be formed. Blank cubes are only used if they have to be. Under
+ * LETTER_BAG the cells need not be adjacent; each letter takes the lowest unused cell showing
+ * it. */
+Vector<int> findWordPath(const BoardGraph& graph, const std::string& word, DiceRule rule);
+
+#endif // _wordsolver_h
@@ -0,0 +1,171 @@
+/* WORST CASE
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * Implements the worst-case board search declared in worstcase.h. The threads claim climbs
+ * from a shared counter, so that slow climbs do not leave the other threads idle, and each
+ * thread mutates the letters of its own copy of the board's graph in place. */
+
+#include "worstcase.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+#include "boggleconstants.h"
+#include "error.h"
+#include "grid.h"
+#include "strlib.h"
+using namespace std;
+
+/* The state shared by the threads of one search. */
+struct WorstCaseSearch {
+    const BoardCost& cost;
+    const WorstCaseOptions& options;
+    atomic<int> nextClimb;
+    mutex lock;                     // guards hallOfFame
+    Vector<CostlyBoard> hallOfFame;
+
+    WorstCaseSearch(const BoardCost& cost, const WorstCaseOptions& options)
+        : cost(cost), options(options), nextClimb(0) {}
+};
+
+/*************************************************
+ *             PROTOTYPE FUNCTIONS               *
+ ************************************************/
+void climbInThread(WorstCaseSearch& search, unsigned seed);
+void mutateBoard(BoardGraph& graph, mt19937& random);
+char randomCubeFace(mt19937& random);
+void enterHallOfFame(WorstCaseSearch& search, const BoardGraph& graph, double cost);
+long countNodesFrom(const BoardGraph& graph, const DictionaryTrie& trie, int cell, int node,
+                    uint64_t visited, int length, int maxLength);
+
+
+/*************************************************
+ *                  FUNCTIONS                    *
+ ************************************************/
+
+Vector<CostlyBoard> findWorstCaseBoards(const BoardCost& cost, const WorstCaseOptions& options) {
+    for(const string& seed : options.seeds) {
+        if((int) seed.length() != options.size * options.size) {
+            error("findWorstCaseBoards: \"" + seed + "\" is not a " + integerToString(options.size) + "x" +
+                  integerToString(options.size) + " board");
+        }
+    }
+    WorstCaseSearch search(cost, options);
+    random_device seeds;
+    vector<thread> workers;
+    for(int i = 0; i < max(1, options.threads); i++) {
+        workers.push_back(thread(climbInThread, ref(search), seeds()));
+    }
+    for(thread& worker : workers) {
+        worker.join();
+    }
+    return search.hallOfFame;
+}
+
+/* Runs climbs until none are left. A climb starts from the seed board of its number, if there
+ * is one, or else from a board of random cube faces. Every board that raises the climb's cost
+ * is offered to the hall of fame, not just the last, since climbs often end on the same
+ * board and the boards on the way up to it are just as worth testing. */
+void climbInThread(WorstCaseSearch& search, unsigned seed) {
+    mt19937 random(seed);
+    const WorstCaseOptions& options = search.options;
+    BoardGraph graph = gridBoardGraph(Grid<char>(options.size, options.size));
+    for(int climb = search.nextClimb++; climb < options.climbs; climb = search.nextClimb++) {
+        string start = climb < options.seeds.size() ? toUpperCase(options.seeds[climb]) : "";
+        for(int cell = 0; cell < graph.cellCount(); cell++) {
+            graph.letters[cell] = start.empty() ? randomCubeFace(random) : start[cell];
+        }
+        double cost = search.cost(graph);
+        enterHallOfFame(search, graph, cost);
+        for(int step = 0; step < options.stepsPerClimb; step++) {
+            Vector<char> previous = graph.letters;
+            mutateBoard(graph, random);
+            double mutatedCost = search.cost(graph);
+            if(mutatedCost > cost) {
+                enterHallOfFame(search, graph, mutatedCost);
+            }
+            if(mutatedCost >= cost) {
+                cost = mutatedCost;
+            } else {
+                graph.letters = previous;
+            }
+        }
+    }
+}
+
+/* Gives one cell a random face of a random cube, or, one time in three, swaps two cells,
+ * which keeps the board's letters and only rearranges them. */
+void mutateBoard(BoardGraph& graph, mt19937& random) {
+    int cell = random() % graph.cellCount();
+    if(random() % 3 == 0) {
+        swap(graph.letters[cell], graph.letters[random() % graph.cellCount()]);
+    } else {
+        graph.letters[cell] = randomCubeFace(random);
+    }
+}
+
+/* Returns a random face of a random Super Big Boggle cube, so letters turn up about as often
+ * as they do in play. */
+char randomCubeFace(mt19937& random) {
+    const string& cube = LETTER_CUBES_SUPER_BIG[random() % LETTER_CUBES_SUPER_BIG.size()];
+    return toupper(cube[random() % cube.length()]);
+}
+
+/* Adds the board to the hall of fame unless it is already there, dropping the cheapest board
+ * if the hall is full. */
+void enterHallOfFame(WorstCaseSearch& search, const BoardGraph& graph, double cost) {
+    string letters(graph.letters.begin(), graph.letters.end());
+    lock_guard<mutex> guard(search.lock);
+    Vector<CostlyBoard>& hallOfFame = search.hallOfFame;
+    for(const CostlyBoard& board : hallOfFame) {
+        if(board.letters == letters) {
+            return;
+        }
+    }
+    hallOfFame.add(CostlyBoard {letters, cost});
+    sort(hallOfFame.begin(), hallOfFame.end(), [](const CostlyBoard& a, const CostlyBoard& b) {
+        return a.cost > b.cost;
+    });
+    while(hallOfFame.size() > search.options.hallOfFameSize) {
+        hallOfFame.remove(hallOfFame.size() - 1);
+    }
+}
+
+long countSearchNodes(const BoardGraph& graph, const DictionaryTrie& trie, int maxLength) {
+    if(!graph.hasMasks()) {
+        error("countSearchNodes: boards of more than " + integerToString(MAX_MASK_CELLS) +
+              " cells are not supported");
+    }
+    long nodes = 0;
+    for(int cell = 0; cell < graph.cellCount(); cell++) {
+        nodes += countNodesFrom(graph, trie, cell, DictionaryTrie::ROOT, 0, 1, maxLength);
+    }
+    return nodes;
+}
+
+/* Returns the nodes entered by the paths that continue from node through cell, the path so
+ * far having used the visited cells and length - 1 letters. */
+long countNodesFrom(const BoardGraph& graph, const DictionaryTrie& trie, int cell, int node,
+                    uint64_t visited, int length, int maxLength) {
+    char letter = graph.letters[cell];
+    uint32_t choices = trie.childMask(node);
+    if(letter != BOARD_WILDCARD) {
+        choices &= letterIndex(letter) == -1 ? 0 : uint32_t(1) << letterIndex(letter);
+    }
+    visited |= uint64_t(1) << cell;
+    long nodes = 0;
+    for(; choices != 0; choices &= choices - 1) {
+        int child = trie.child(node, __builtin_ctz(choices));
+        nodes++;
+        if(maxLength == 0 || length < maxLength) {
+            for(uint64_t next = graph.neighborMasks[cell] & ~visited; next != 0; next &= next - 1) {
+                nodes += countNodesFrom(graph, trie, lowestCell(next), child, visited, length + 1, maxLength);
+            }
+        }
+    }
+    return nodes;
+}
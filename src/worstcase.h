@@ -0,0 +1,55 @@
+/* WORST CASE
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * A search for the boards that are slowest to solve, to find the tail of the solver's latency
+ * before players do. It climbs from random boards by mutating one board at a time: a cell is
+ * given a random face of a random cube, or two cells swap letters. A mutation is kept if the
+ * board costs at least as much as before, so climbs can drift across plateaus. The hall of
+ * fame holds the costliest distinct boards met by any climb.
+ *
+ * What a board costs is up to the caller. countSearchNodes gives a cost that is the same on
+ * every run: the trie nodes entered by the classic depth-first search, one per path prefix
+ * that the dictionary continues. Time is what matters in the end, but it is noisy, so a timed
+ * cost should take the fastest of a few solves and run on one thread. */
+
+#ifndef _worstcase_h
+#define _worstcase_h
+
+#include <functional>
+#include <string>
+#include "boardgraph.h"
+#include "dictionarytrie.h"
+#include "vector.h"
+
+struct WorstCaseOptions {
+    int size;                   // the boards are size x size
+    int threads;                // number of threads to split the climbs across
+    int climbs;                 // number of climbs in all
+    int stepsPerClimb;          // mutations tried per climb
+    int hallOfFameSize;         // boards kept
+    Vector<std::string> seeds;  // boards for the first climbs to start from instead of random ones
+
+    WorstCaseOptions() : size(4), threads(1), climbs(32), stepsPerClimb(2000), hallOfFameSize(20) {}
+};
+
+/* A board of the hall of fame. */
+struct CostlyBoard {
+    std::string letters;    // the cells in row-major order, as in a corpus
+    double cost;
+};
+
+/* Returns the cost of solving a board; it is called from several threads at once. */
+typedef std::function<double(const BoardGraph& graph)> BoardCost;
+
+/* Runs the climbs and returns the hall of fame, costliest first, without duplicate boards.
+ * Throws an ErrorException if a seed board is not of the given size. */
+Vector<CostlyBoard> findWorstCaseBoards(const BoardCost& cost, const WorstCaseOptions& options);
+
+/* Returns the number of trie nodes the depth-first search enters on the board under the
+ * USE_EACH_CUBE_ONCE rule, stopping at paths of maxLength cells unless it is 0. A blank cube
+ * enters every child of the node. Throws an ErrorException if the board has more than
+ * MAX_MASK_CELLS cells. */
+long countSearchNodes(const BoardGraph& graph, const DictionaryTrie& trie, int maxLength = 0);
+
+#endif // _worstcase_h
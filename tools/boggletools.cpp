@@ -0,0 +1,836 @@
+/* BOGGLE TOOLS
+ * Author: Adonis Pugh
+
+ * ----------------------------
+ * A command-line companion to the game for batch work on corpora of boards (see corpus.h).
+ * It is a separate program from the game and is built from this file together with the
+ * non-GUI sources in src/. Each subcommand loads the same dictionary file as the game.
+ *
+ *     boggletools index <corpus> <index>
+ *         Solves every board of the corpus and writes its word index.
+ *     boggletools reindex <old dictionary> <corpus> <old index> <new index>
+ *         Updates an index built with an older dictionary file to the current dictionary,
+ *         searching the boards only for the words it added (see updateWordIndex in
+ *         wordindex.h), and prints the words added and removed and the time taken.
+ *     boggletools query <index> WORD ... -WORD ...
+ *         Prints the ids of the boards containing every WORD and none of the -WORDs.
+ *     boggletools minhash <corpus> <similarity index>
+ *         Solves every board of the corpus and writes its similarity index.
+ *     boggletools similar <similarity index> <board id or letters> [count]
+ *         Prints the boards most similar to the given one, 20 by default.
+ *     boggletools rate <corpus> [rule set]
+ *         Prints each board's difficulty, word count, and total points, under the numbered
+ *         rule set (see ruleSets in gamerules.h), the standard rules by default.
+ *     boggletools anagram <letters> [min length]
+ *         Prints every word that can be built from the letters, ignoring adjacency, of at
+ *         least MIN_WORD_LENGTH letters by default. A '?' is a blank cube.
+ *     boggletools replay <game log>
+ *         Replays every game of a log written by the game (see gamelog.h) against the current
+ *         solver and dictionary, printing each difference and the replay speed.
+ *     boggletools bench <corpus> [prefetch distance ...]
+ *         Solves the corpus on one thread with the dictionary on normal pages and then on huge
+ *         pages (see hugepages.h), printing the time and data TLB misses of each, and then
+ *         again on huge pages without vector moves and with each given trie prefetch
+ *         distance (see SolveOptions).
+ *     boggletools succinct <corpus>
+ *         Prints the memory used by the dictionary as a DictionaryTrie and as a LoudsTrie (see
+ *         loudstrie.h), then solves the corpus on one thread with each, printing the times and
+ *         any board on which they disagree.
+ *     boggletools corpuscheck <corpus>
+ *         Solves the corpus through solveCorpus, on one thread and on every hardware thread,
+ *         and checks each board's words and path counts against a direct solve, for the
+ *         boards as given and again with a blank cube on their first cell. Prints any board
+ *         that differs.
+ *     boggletools maptrie <trie file>
+ *         Compiles the dictionary into a file for MappedTrie (see mappedtrie.h).
+ *     boggletools outofcore <trie file> <corpus> [bloom depth ...]
+ *         Solves the corpus on one thread with the mapped trie file, once for each Bloom
+ *         filter depth (no filter and the default depth if none are given), starting each
+ *         with the file out of memory and printing the filter's size, the time, how much of
+ *         the file was read, and the page faults of each run.
+ *     boggletools tiers <corpus> [frequency file]
+ *         Sorts the dictionary's words into tiers by the frequency list (see loadWordTiers in
+ *         difficulty.h), then solves the corpus on one thread once with every word and once
+ *         limited to each tier, printing the words found and the time of each.
+ *     boggletools maxboard <rows>x<cols> <target> <checkpoint> [workers]
+ *         Searches for the highest-scoring board of the given size under the standard rules
+ *         (see maxboard.h), keeping every board that scores at least the target. The search
+ *         is split among worker processes, one by default, each saving its shard to the
+ *         checkpoint file name followed by its shard number, or to the file itself if there
+ *         is one worker. Running the same command again resumes it. Prints the progress of
+ *         each shard, then the best boards found and whether the search is complete.
+ *     boggletools worstcase <size> <climbs> <nodes|dictionary|louds|trie file> [corpus]
+ *         Searches for the size x size boards that are slowest to solve (see worstcase.h),
+ *         by the trie nodes the search enters or by the time the given engine takes to solve
+ *         them: the DictionaryTrie, the LoudsTrie, or the MappedTrie of a trie file. Prints
+ *         the hall of fame with each board's nodes and solve time, and appends its boards to
+ *         the corpus, if given, for benchmarking. */
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "boardsimilarity.h"
+#include "boggleconstants.h"
+#include "corpus.h"
+#include "dictionarytrie.h"
+#include "difficulty.h"
+#include "error.h"
+#include "gamelog.h"
+#include "gamerules.h"
+#include "hugepages.h"
+#include "letterbag.h"
+#include "lexicon.h"
+#include "loudstrie.h"
+#include "mappedtrie.h"
+#include "maxboard.h"
+#include "strlib.h"
+#include "tlbcounter.h"
+#include "vector.h"
+#include "wordindex.h"
+#include "worstcase.h"
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+/*************************************************
+ *             PROTOTYPE FUNCTIONS               *
+ ************************************************/
+int runIndex(const Vector<string>& args);
+int runReindex(const Vector<string>& args);
+int runQuery(const Vector<string>& args);
+int runMinHash(const Vector<string>& args);
+int runSimilar(const Vector<string>& args);
+int runRate(const Vector<string>& args);
+int runAnagram(const Vector<string>& args);
+int runReplay(const Vector<string>& args);
+int runBench(const Vector<string>& args);
+int runSuccinct(const Vector<string>& args);
+int runCorpusCheck(const Vector<string>& args);
+int runMapTrie(const Vector<string>& args);
+int runOutOfCore(const Vector<string>& args);
+int runTiers(const Vector<string>& args);
+int runMaxBoard(const Vector<string>& args);
+int searchMaxBoardShard(const DictionaryTrie& trie, const MaxBoardOptions& options);
+int runWorstCase(const Vector<string>& args);
+template <typename Trie>
+double fastestSolveMicroseconds(const BoardGraph& graph, const Trie& trie);
+void benchSolve(const Vector<string>& boards, const DictionaryTrie& trie, const SolveOptions& options,
+                TlbMissCounter& counter, const string& label);
+const DictionaryTrie& loadDictionary();
+int wordIdOf(const DictionaryTrie& trie, const string& word);
+int hardwareThreads();
+long pageFaults(bool major);
+double millisecondsSince(chrono::steady_clock::time_point start);
+int usage();
+
+
+/*************************************************
+ *                  FUNCTIONS                    *
+ ************************************************/
+
+int main(int argc, char** argv) {
+    Vector<string> args;
+    for(int i = 1; i < argc; i++) {
+        args.add(argv[i]);
+    }
+    if(args.isEmpty()) {
+        return usage();
+    }
+    try {
+        string command = args[0];
+        args.remove(0);
+        if(command == "index") {
+            return runIndex(args);
+        } else if(command == "reindex") {
+            return runReindex(args);
+        } else if(command == "query") {
+            return runQuery(args);
+        } else if(command == "minhash") {
+            return runMinHash(args);
+        } else if(command == "similar") {
+            return runSimilar(args);
+        } else if(command == "rate") {
+            return runRate(args);
+        } else if(command == "anagram") {
+            return runAnagram(args);
+        } else if(command == "replay") {
+            return runReplay(args);
+        } else if(command == "bench") {
+            return runBench(args);
+        } else if(command == "succinct") {
+            return runSuccinct(args);
+        } else if(command == "corpuscheck") {
+            return runCorpusCheck(args);
+        } else if(command == "maptrie") {
+            return runMapTrie(args);
+        } else if(command == "outofcore") {
+            return runOutOfCore(args);
+        } else if(command == "tiers") {
+            return runTiers(args);
+        } else if(command == "maxboard") {
+            return runMaxBoard(args);
+        } else if(command == "worstcase") {
+            return runWorstCase(args);
+        }
+        return usage();
+    } catch(ErrorException& ex) {
+        cerr << ex.getMessage() << endl;
+        return 1;
+    }
+}
+
+/* index <corpus> <index> */
+int runIndex(const Vector<string>& args) {
+    if(args.size() != 2) {
+        return usage();
+    }
+    const DictionaryTrie& trie = loadDictionary();
+    Vector<string> boards = readCorpus(args[0]);
+    auto start = chrono::steady_clock::now();
+    buildWordIndex(boards, trie, args[1], hardwareThreads());
+    cout << "Indexed " << boards.size() << " boards in " << millisecondsSince(start) << " ms" << endl;
+    return 0;
+}
+
+/* reindex <old dictionary> <corpus> <old index> <new index>. The old index stays mapped
+ * while the new one is written, so they must be different files. */
+int runReindex(const Vector<string>& args) {
+    if(args.size() != 4) {
+        return usage();
+    }
+    if(args[2] == args[3]) {
+        error("reindex: the new index must be written to a different file");
+    }
+    auto start = chrono::steady_clock::now();
+    DictionaryTrie oldTrie((Lexicon(args[0])));
+    const DictionaryTrie& trie = loadDictionary();
+    WordIndex oldIndex(args[2]);
+    DictionaryDiff diff = updateWordIndex(oldIndex, oldTrie, readCorpus(args[1]), trie, args[3],
+                                          hardwareThreads());
+    cerr << diff.added.size() << " words added and " << diff.removed.size() << " removed; updated "
+         << oldIndex.boardCount() << " boards in " << millisecondsSince(start) << " ms" << endl;
+    return 0;
+}
+
+/* query <index> WORD ... -WORD ... */
+int runQuery(const Vector<string>& args) {
+    if(args.size() < 2) {
+        return usage();
+    }
+    const DictionaryTrie& trie = loadDictionary();
+    WordIndex index(args[0]);
+    if(index.fingerprint() != trie.fingerprint()) {
+        error("query: " + args[0] + " was built with a different dictionary");
+    }
+    Vector<int> required;
+    Vector<int> excluded;
+    for(int i = 1; i < args.size(); i++) {
+        if(startsWith(args[i], "-")) {
+            excluded.add(wordIdOf(trie, args[i].substr(1)));
+        } else {
+            required.add(wordIdOf(trie, args[i]));
+        }
+    }
+    auto start = chrono::steady_clock::now();
+    Vector<int> boards = index.query(required, excluded).toVector();
+    double elapsed = millisecondsSince(start);
+    for(int board : boards) {
+        cout << board << endl;
+    }
+    cerr << boards.size() << " of " << index.boardCount() << " boards match (" << elapsed << " ms)" << endl;
+    return 0;
+}
+
+/* minhash <corpus> <similarity index> */
+int runMinHash(const Vector<string>& args) {
+    if(args.size() != 2) {
+        return usage();
+    }
+    const DictionaryTrie& trie = loadDictionary();
+    Vector<string> boards = readCorpus(args[0]);
+    auto start = chrono::steady_clock::now();
+    buildSimilarityIndex(boards, trie, args[1], hardwareThreads());
+    cout << "Signed " << boards.size() << " boards in " << millisecondsSince(start) << " ms" << endl;
+    return 0;
+}
+
+/* similar <similarity index> <board id or letters> [count]. A board given by its letters is
+ * solved on the spot to get its signature. */
+int runSimilar(const Vector<string>& args) {
+    if(args.size() != 2 && args.size() != 3) {
+        return usage();
+    }
+    const DictionaryTrie& trie = loadDictionary();
+    SimilarityIndex index(args[0]);
+    if(index.fingerprint() != trie.fingerprint()) {
+        error("similar: " + args[0] + " was built with a different dictionary");
+    }
+    int count = args.size() == 3 ? stringToInteger(args[2]) : 20;
+    int board = -1;
+    MinHashSignature signature;
+    if(stringIsInteger(args[1])) {
+        board = stringToInteger(args[1]);
+        signature = index.signature(board);
+    } else {
+        signature = minHashSignature(solveBoard(corpusBoardGraph(toUpperCase(args[1])), trie));
+    }
+    auto start = chrono::steady_clock::now();
+    Vector<SimilarBoard> similar = index.mostSimilar(signature, count, board);
+    double elapsed = millisecondsSince(start);
+    for(const SimilarBoard& match : similar) {
+        cout << match.board << " " << match.similarity << endl;
+    }
+    cerr << similar.size() << " similar boards (" << elapsed << " ms)" << endl;
+    return 0;
+}
+
+/* rate <corpus> [rule set]. The boards are solved with path counting and rated as their results
+ * come in. Only when the rules count QU as one letter are the solver's words checked again. */
+int runRate(const Vector<string>& args) {
+    if(args.size() != 1 && args.size() != 2) {
+        return usage();
+    }
+    Vector<GameRules> rules = ruleSets();
+    int ruleSet = args.size() == 2 ? stringToInteger(args[1]) : 1;
+    if(ruleSet < 1 || ruleSet > rules.size()) {
+        error("there is no rule set " + args[1]);
+    }
+    const GameRules& gameRules = rules[ruleSet - 1];
+    const DictionaryTrie& trie = loadDictionary();
+    DifficultyRater rater(trie, FREQUENCY_FILE, gameRules);
+    Vector<string> boards = readCorpus(args[0]);
+    SolveOptions options = gameRules.solveOptions();
+    options.countPaths = true;
+    auto start = chrono::steady_clock::now();
+    solveCorpus(boards, trie, options, hardwareThreads(),
+                [&](int board, const Vector<int>& wordIds, const Vector<int>& pathCounts) {
+        DifficultyRating rating;
+        if(gameRules.quRule != QU_ONE_LETTER) {
+            rating = rater.rate(wordIds, pathCounts);
+        } else {
+            Vector<int> allowedIds;
+            Vector<int> allowedCounts;
+            for(int i = 0; i < wordIds.size(); i++) {
+                if(gameRules.allows(trie.word(wordIds[i]))) {
+                    allowedIds.add(wordIds[i]);
+                    allowedCounts.add(pathCounts[i]);
+                }
+            }
+            rating = rater.rate(allowedIds, allowedCounts);
+        }
+        cout << board << " " << rating.difficulty << " " << rating.wordCount << " " << rating.totalPoints << endl;
+    });
+    cerr << "Rated " << boards.size() << " boards in " << millisecondsSince(start) << " ms"
+         << (rater.hasFrequencies() ? "" : " (no " + FREQUENCY_FILE + ")") << endl;
+    return 0;
+}
+
+/* anagram <letters> [min length]. The timing covers the search alone, not loading the
+ * dictionary. */
+int runAnagram(const Vector<string>& args) {
+    if(args.size() != 1 && args.size() != 2) {
+        return usage();
+    }
+    const DictionaryTrie& trie = loadDictionary();
+    LetterBag bag = letterBag(toUpperCase(args[0]));
+    int minLength = args.size() == 2 ? stringToInteger(args[1]) : MIN_WORD_LENGTH;
+    auto start = chrono::steady_clock::now();
+    Vector<int> words = anagramWords(trie, bag, minLength);
+    double elapsed = millisecondsSince(start);
+    for(int id : words) {
+        cout << trie.word(id) << endl;
+    }
+    cerr << words.size() << " words (" << elapsed << " ms)" << endl;
+    return 0;
+}
+
+/* replay <game log>. Exits with 1 if anything differs from the log. */
+int runReplay(const Vector<string>& args) {
+    if(args.size() != 1) {
+        return usage();
+    }
+    const DictionaryTrie& trie = loadDictionary();
+    auto start = chrono::steady_clock::now();
+    ReplayReport report = replayGameLog(args[0], trie, [](const LoggedGame& game, const string& problem) {
+        cout << "game of " << game.startTime << " (" << game.letters << "): " << problem << endl;
+    });
+    double elapsed = millisecondsSince(start);
+    cerr << "Replayed " << report.games << " games, " << report.events << " events in " << elapsed << " ms ("
+         << (long) (report.events / max(elapsed / 1000, 1e-9)) << " events/s); " << report.skippedGames
+         << " skipped, " << report.verdictMismatches << " verdict and " << report.solutionMismatches
+         << " solution mismatches" << endl;
+    return report.verdictMismatches + report.solutionMismatches > 0 ? 1 : 0;
+}
+
+/* bench <corpus> [prefetch distance ...]. The dictionary is compiled again for each page
+ * size, with huge pages off for the first and on for the second; the search without vector
+ * moves and the distances are then run on huge pages. Only the solving is timed and counted. */
+int runBench(const Vector<string>& args) {
+    if(args.isEmpty()) {
+        return usage();
+    }
+    Lexicon lexicon(DICTIONARY_FILE);
+    Vector<string> boards = readCorpus(args[0]);
+    TlbMissCounter counter;
+    if(!counter.available()) {
+        cerr << "dTLB misses cannot be counted on this system" << endl;
+    }
+    for(bool hugePages : {false, true}) {
+        setHugePagesEnabled(hugePages);
+        HugePageUsage before = hugePageUsage();
+        DictionaryTrie trie(lexicon);
+        HugePageUsage after = hugePageUsage();
+        benchSolve(boards, trie, SolveOptions(), counter, hugePages ? "huge pages" : "normal pages");
+        cout << "  compiling mapped " << (after.explicitBytes - before.explicitBytes) / 1024
+             << " KB explicit, " << (after.transparentBytes - before.transparentBytes) / 1024
+             << " KB transparent, " << (after.normalBytes - before.normalBytes) / 1024 << " KB normal"
+             << endl;
+        if(hugePages) {
+            SolveOptions scalar;
+            scalar.vectorMoves = false;
+            benchSolve(boards, trie, scalar, counter, "scalar moves");
+            for(int i = 1; i < args.size(); i++) {
+                SolveOptions options;
+                options.prefetchDistance = stringToInteger(args[i]);
+                benchSolve(boards, trie, options, counter, "prefetch distance " + args[i]);
+            }
+        }
+    }
+    return 0;
+}
+
+/* succinct <corpus>. The board graphs are built before either run so that only solving is
+ * timed. Exits with 1 if the two tries find different words on any board. */
+int runSuccinct(const Vector<string>& args) {
+    if(args.size() != 1) {
+        return usage();
+    }
+    Vector<string> boards = readCorpus(args[0]);
+    vector<BoardGraph> graphs;
+    for(const string& board : boards) {
+        graphs.push_back(corpusBoardGraph(board));
+    }
+    const DictionaryTrie& trie = loadDictionary();
+    LoudsTrie louds(trie);
+    cout << "DictionaryTrie: " << trie.nodeCount() << " nodes, " << trie.memoryBytes() / 1024 << " KB ("
+         << trie.memoryBytes() * 8.0 / trie.nodeCount() << " bits per node)" << endl;
+    cout << "LoudsTrie: " << louds.nodeCount() << " nodes, " << louds.memoryBytes() / 1024 << " KB ("
+         << louds.memoryBytes() * 8.0 / louds.nodeCount() << " bits per node)" << endl;
+    vector<Vector<int>> expected;
+    auto start = chrono::steady_clock::now();
+    for(const BoardGraph& graph : graphs) {
+        expected.push_back(solveBoard(graph, trie));
+    }
+    double arrayTime = millisecondsSince(start);
+    int mismatches = 0;
+    start = chrono::steady_clock::now();
+    for(int i = 0; i < (int) graphs.size(); i++) {
+        if(!(solveBoard(graphs[i], louds) == expected[i])) {
+            cout << "board " << i << " (" << boards[i] << ") differs" << endl;
+            mismatches++;
+        }
+    }
+    double loudsTime = millisecondsSince(start);
+    cout << "DictionaryTrie: " << boards.size() << " boards in " << arrayTime << " ms ("
+         << (long) (boards.size() / max(arrayTime / 1000, 1e-9)) << " boards/s)" << endl;
+    cout << "LoudsTrie: " << boards.size() << " boards in " << loudsTime << " ms ("
+         << (long) (boards.size() / max(loudsTime / 1000, 1e-9)) << " boards/s), "
+         << loudsTime / max(arrayTime, 1e-9) << "x the time" << endl;
+    return mismatches > 0 ? 1 : 0;
+}
+
+/* corpuscheck <corpus>. The blank-cube copies make sure the words found only through blanks
+ * are covered even if the corpus has no blank cubes, since they are the results a solve can
+ * carry over from one board to the next. Exits with 1 if any board differs. */
+int runCorpusCheck(const Vector<string>& args) {
+    if(args.size() != 1) {
+        return usage();
+    }
+    Vector<string> boards = readCorpus(args[0]);
+    for(int i = 0, count = boards.size(); i < count; i++) {
+        boards.add(string(1, BOARD_WILDCARD) + boards[i].substr(1));
+    }
+    const DictionaryTrie& trie = loadDictionary();
+    SolveOptions options;
+    options.countPaths = true;
+    vector<Vector<int>> expectedIds;
+    vector<Vector<int>> expectedCounts;
+    for(const string& board : boards) {
+        Map<int, string> wildcardSpellings;
+        Vector<int> pathCounts;
+        expectedIds.push_back(solveBoard(corpusBoardGraph(board), trie, options, wildcardSpellings,
+                                         pathCounts));
+        expectedCounts.push_back(pathCounts);
+    }
+    int mismatches = 0;
+    for(int threads : {1, hardwareThreads()}) {
+        solveCorpus(boards, trie, options, threads,
+                    [&](int board, const Vector<int>& wordIds, const Vector<int>& pathCounts) {
+            if(!(wordIds == expectedIds[board]) || !(pathCounts == expectedCounts[board])) {
+                cout << "board " << board << " (" << boards[board] << ") differs on " << threads
+                     << " threads: " << wordIds.size() << " words instead of " << expectedIds[board].size()
+                     << endl;
+                mismatches++;
+            }
+        });
+    }
+    cout << boards.size() << " boards checked, " << mismatches << " differences" << endl;
+    return mismatches > 0 ? 1 : 0;
+}
+
+/* maptrie <trie file> */
+int runMapTrie(const Vector<string>& args) {
+    if(args.size() != 1) {
+        return usage();
+    }
+    const DictionaryTrie& trie = loadDictionary();
+    writeMappedTrie(trie, args[0]);
+    cerr << "Wrote " << trie.nodeCount() << " nodes and " << trie.wordCount() << " words to "
+         << args[0] << endl;
+    return 0;
+}
+
+/* outofcore <trie file> <corpus> [bloom depth ...]. The file's pages are dropped from memory
+ * after the Bloom filter is built, so each run reads the pages it touches from disk itself
+ * and the bytes left resident afterwards are what it read; the first run's results are the
+ * ones the others are checked against. Exits with 1 if any run disagrees. */
+int runOutOfCore(const Vector<string>& args) {
+    if(args.size() < 2) {
+        return usage();
+    }
+    Vector<string> boards = readCorpus(args[1]);
+    vector<BoardGraph> graphs;
+    for(const string& board : boards) {
+        graphs.push_back(corpusBoardGraph(board));
+    }
+    Vector<int> depths;
+    for(int i = 2; i < args.size(); i++) {
+        depths.add(stringToInteger(args[i]));
+    }
+    if(depths.isEmpty()) {
+        depths.add(0);
+        depths.add(DEFAULT_BLOOM_DEPTH);
+    }
+    vector<Vector<int>> expected;
+    int mismatches = 0;
+    for(int depth : depths) {
+        MappedTrie trie(args[0], depth);
+        trie.evictPages();
+        long minorFaults = pageFaults(false);
+        long majorFaults = pageFaults(true);
+        auto start = chrono::steady_clock::now();
+        for(int i = 0; i < (int) graphs.size(); i++) {
+            Vector<int> wordIds = solveBoard(graphs[i], trie);
+            if(expected.size() < graphs.size()) {
+                expected.push_back(wordIds);
+            } else if(!(wordIds == expected[i])) {
+                cout << "board " << i << " (" << boards[i] << ") differs at bloom depth " << depth << endl;
+                mismatches++;
+            }
+        }
+        double elapsed = millisecondsSince(start);
+        cout << "bloom depth " << depth << ": " << trie.residentBytes() / 1024 << " KB resident, "
+             << boards.size() << " boards in " << elapsed << " ms ("
+             << (long) (boards.size() / max(elapsed / 1000, 1e-9)) << " boards/s), "
+             << trie.pagedInBytes() / 1024 << " KB of the file read, "
+             << pageFaults(false) - minorFaults << " minor and " << pageFaults(true) - majorFaults
+             << " major page faults" << endl;
+    }
+    return mismatches > 0 ? 1 : 0;
+}
+
+/* tiers <corpus> [frequency file]. Each limited solve is checked against the words of the
+ * full one that are no rarer than its tier. Exits with 1 if any differs. */
+int runTiers(const Vector<string>& args) {
+    if(args.size() < 1 || args.size() > 2) {
+        return usage();
+    }
+    string frequencyFile = args.size() > 1 ? args[1] : FREQUENCY_FILE;
+    DictionaryTrie trie((Lexicon(DICTIONARY_FILE)));
+    if(!loadWordTiers(trie, frequencyFile)) {
+        error("tiers: cannot read " + frequencyFile);
+    }
+    Vector<string> boards = readCorpus(args[0]);
+    vector<BoardGraph> graphs;
+    for(const string& board : boards) {
+        graphs.push_back(corpusBoardGraph(board));
+    }
+    const string tierNames[] = {"common", "familiar", "uncommon", "rare"};
+    vector<Vector<int>> full;
+    double fullTime = 0;
+    int mismatches = 0;
+    for(int tier = RARE_WORD; tier >= COMMON_WORD; tier--) {
+        SolveOptions options;
+        options.rarestTier = WordTier(tier);
+        long words = 0;
+        auto start = chrono::steady_clock::now();
+        for(int i = 0; i < (int) graphs.size(); i++) {
+            Vector<int> wordIds = solveBoard(graphs[i], trie, options);
+            words += wordIds.size();
+            if(tier == RARE_WORD) {
+                full.push_back(wordIds);
+                continue;
+            }
+            Vector<int> expected;
+            for(int id : full[i]) {
+                if(trie.wordTier(id) <= tier) {
+                    expected.add(id);
+                }
+            }
+            if(!(wordIds == expected)) {
+                cout << "board " << i << " (" << boards[i] << ") differs up to " << tierNames[tier]
+                     << " words" << endl;
+                mismatches++;
+            }
+        }
+        double elapsed = millisecondsSince(start);
+        fullTime = tier == RARE_WORD ? elapsed : fullTime;
+        cout << "up to " << tierNames[tier] << " words: " << words << " words on " << boards.size()
+             << " boards in " << elapsed << " ms, " << elapsed / max(fullTime, 1e-9)
+             << "x the full solve" << endl;
+    }
+    return mismatches > 0 ? 1 : 0;
+}
+
+/* maxboard <rows>x<cols> <target> <checkpoint> [workers]. The dictionary is compiled before
+ * the workers are forked so that they share its pages; where there is no fork, the shards
+ * are searched one after another instead. The results are collected from the checkpoints, so
+ * a shard finished by an earlier run counts even if this run did not search it. */
+int runMaxBoard(const Vector<string>& args) {
+    if(args.size() < 3 || args.size() > 4) {
+        return usage();
+    }
+    MaxBoardOptions options;
+    size_t by = args[0].find('x');
+    options.rows = stringToInteger(args[0].substr(0, by));
+    options.cols = by == string::npos ? options.rows : stringToInteger(args[0].substr(by + 1));
+    options.target = stringToInteger(args[1]);
+    options.shards = args.size() > 3 ? stringToInteger(args[3]) : 1;
+    if(options.shards < 1) {
+        error("maxboard: there must be at least one worker");
+    }
+    options.threads = max(1, hardwareThreads() / options.shards);
+    const DictionaryTrie& trie = loadDictionary();
+    Vector<string> checkpoints;
+    for(int shard = 0; shard < options.shards; shard++) {
+        checkpoints.add(options.shards == 1 ? args[2] : args[2] + "." + integerToString(shard));
+    }
+    auto start = chrono::steady_clock::now();
+    int failures = 0;
+#ifndef _WIN32
+    Vector<pid_t> workers;
+    for(int shard = 0; shard < options.shards; shard++) {
+        MaxBoardOptions shardOptions = options;
+        shardOptions.shard = shard;
+        shardOptions.checkpointFile = checkpoints[shard];
+        pid_t pid = fork();
+        if(pid == 0) {
+            _exit(searchMaxBoardShard(trie, shardOptions));
+        } else if(pid < 0) {
+            error("maxboard: cannot start worker " + integerToString(shard));
+        }
+        workers.add(pid);
+    }
+    for(pid_t pid : workers) {
+        int status;
+        if(waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            failures++;
+        }
+    }
+#else
+    for(int shard = 0; shard < options.shards; shard++) {
+        MaxBoardOptions shardOptions = options;
+        shardOptions.shard = shard;
+        shardOptions.checkpointFile = checkpoints[shard];
+        failures += searchMaxBoardShard(trie, shardOptions) != 0;
+    }
+#endif
+    long unitsDone = 0;
+    long unitCount = 0;
+    Vector<MaxBoardFind> finds;
+    for(const string& checkpoint : checkpoints) {
+        MaxBoardProgress progress = readMaxBoardCheckpoint(checkpoint);
+        unitsDone += progress.unitsDone;
+        unitCount += progress.unitCount;
+        for(const MaxBoardFind& find : progress.finds) {
+            finds.add(find);
+        }
+    }
+    sort(finds.begin(), finds.end(), [](const MaxBoardFind& a, const MaxBoardFind& b) {
+        return a.score != b.score ? a.score > b.score : a.letters < b.letters;
+    });
+    for(const MaxBoardFind& find : finds) {
+        if(find.score == finds[0].score) {
+            cout << find.letters << " " << find.score << endl;
+        }
+    }
+    cout << (unitsDone == unitCount ? "complete" : "incomplete") << ": " << unitsDone << " of "
+         << unitCount << " units done, " << failures << " workers failed, "
+         << millisecondsSince(start) / 1000 << " s" << endl;
+    return failures > 0 || unitsDone != unitCount ? 1 : 0;
+}
+
+/* Searches one shard, printing its progress every time its checkpoint is saved. Returns the
+ * exit status of a worker: 0 if the shard was finished, 1 if not. */
+int searchMaxBoardShard(const DictionaryTrie& trie, const MaxBoardOptions& options) {
+    try {
+        MaxBoardProgress progress = searchMaxBoard(trie, standardRules(), options,
+                                                   [](const MaxBoardProgress& saved) {
+            cerr << "shard " << saved.shard << ": " << saved.unitsDone << " of " << saved.unitCount
+                 << " units, best " << saved.target << ", " << saved.classesBounded << " classes bounded, "
+                 << saved.boardsScored << " boards scored" << endl;
+        });
+        return progress.complete() ? 0 : 1;
+    } catch(ErrorException& ex) {
+        cerr << "shard " << options.shard << ": " << ex.getMessage() << endl;
+        return 1;
+    }
+}
+
+/* worstcase <size> <climbs> <nodes|dictionary|louds|trie file> [corpus]. Node counts are the
+ * same whichever trie is searched, so they are taken on the DictionaryTrie and spread across
+ * every hardware thread; timed climbs run on one thread so that they do not slow each other. */
+int runWorstCase(const Vector<string>& args) {
+    if(args.size() < 3 || args.size() > 4) {
+        return usage();
+    }
+    WorstCaseOptions options;
+    options.size = stringToInteger(args[0]);
+    options.climbs = stringToInteger(args[1]);
+    string engine = args[2];
+    const DictionaryTrie& trie = loadDictionary();
+    unique_ptr<LoudsTrie> louds;
+    unique_ptr<MappedTrie> mapped;
+    BoardCost cost;
+    if(engine == "nodes") {
+        options.threads = hardwareThreads();
+        cost = [&trie](const BoardGraph& graph) {
+            return (double) countSearchNodes(graph, trie);
+        };
+    } else if(engine == "dictionary") {
+        cost = [&trie](const BoardGraph& graph) {
+            return fastestSolveMicroseconds(graph, trie);
+        };
+    } else if(engine == "louds") {
+        louds.reset(new LoudsTrie(trie));
+        cost = [&louds](const BoardGraph& graph) {
+            return fastestSolveMicroseconds(graph, *louds);
+        };
+    } else {
+        mapped.reset(new MappedTrie(engine));
+        if(mapped->fingerprint() != trie.fingerprint()) {
+            error("worstcase: " + engine + " was built with a different dictionary");
+        }
+        cost = [&mapped](const BoardGraph& graph) {
+            return fastestSolveMicroseconds(graph, *mapped);
+        };
+    }
+    auto start = chrono::steady_clock::now();
+    Vector<CostlyBoard> hallOfFame = findWorstCaseBoards(cost, options);
+    cerr << options.climbs << " climbs in " << millisecondsSince(start) / 1000 << " s" << endl;
+    Vector<string> boards;
+    for(const CostlyBoard& board : hallOfFame) {
+        BoardGraph graph = corpusBoardGraph(board.letters);
+        cout << board.letters << " " << countSearchNodes(graph, trie) << " nodes, "
+             << fastestSolveMicroseconds(graph, trie) << " us" << endl;
+        boards.add(board.letters);
+    }
+    if(args.size() > 3) {
+        appendToCorpus(args[3], boards, "worst-case " + args[0] + "x" + args[0] + " boards by " + engine);
+    }
+    return 0;
+}
+
+/* Returns the fastest of a few single-threaded solves of the board, in microseconds. */
+template <typename Trie>
+double fastestSolveMicroseconds(const BoardGraph& graph, const Trie& trie) {
+    const int runs = 3;
+    double fastest = 0;
+    for(int run = 0; run < runs; run++) {
+        auto start = chrono::steady_clock::now();
+        solveBoard(graph, trie);
+        double elapsed = millisecondsSince(start) * 1000;
+        fastest = run == 0 ? elapsed : min(fastest, elapsed);
+    }
+    return fastest;
+}
+
+/* Solves every board on the calling thread and prints the time and data TLB misses. */
+void benchSolve(const Vector<string>& boards, const DictionaryTrie& trie, const SolveOptions& options,
+                TlbMissCounter& counter, const string& label) {
+    long words = 0;
+    auto start = chrono::steady_clock::now();
+    counter.start();
+    solveCorpus(boards, trie, options, 1, [&](int, const Vector<int>& wordIds, const Vector<int>&) {
+        words += wordIds.size();
+    });
+    uint64_t misses = counter.stop();
+    double elapsed = millisecondsSince(start);
+    cout << label << ": " << boards.size() << " boards, " << words << " words in " << elapsed << " ms ("
+         << (long) (boards.size() / max(elapsed / 1000, 1e-9)) << " boards/s)";
+    if(counter.available()) {
+        cout << ", " << misses << " dTLB misses (" << misses / max(1, boards.size()) << " per board)";
+    }
+    cout << endl;
+}
+
+/* Compiles the game's dictionary the first time it is needed. */
+const DictionaryTrie& loadDictionary() {
+    static DictionaryTrie trie((Lexicon(DICTIONARY_FILE)));
+    return trie;
+}
+
+/* Returns the id of the given word, or throws an ErrorException if it is not a word. */
+int wordIdOf(const DictionaryTrie& trie, const string& word) {
+    int node = trie.find(toUpperCase(word));
+    if(node == DictionaryTrie::NONE || trie.wordId(node) == DictionaryTrie::NONE) {
+        error("\"" + word + "\" is not in the dictionary");
+    }
+    return trie.wordId(node);
+}
+
+/* Returns the process's minor or major page faults so far, or 0 where they are not counted. */
+long pageFaults(bool major) {
+#ifndef _WIN32
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return major ? usage.ru_majflt : usage.ru_minflt;
+#else
+    return 0;
+#endif
+}
+
+int hardwareThreads() {
+    return max(1u, thread::hardware_concurrency());
+}
+
+double millisecondsSince(chrono::steady_clock::time_point start) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+int usage() {
+    cerr << "usage: boggletools index <corpus> <index>" << endl;
+    cerr << "       boggletools reindex <old dictionary> <corpus> <old index> <new index>" << endl;
+    cerr << "       boggletools query <index> WORD ... -WORD ..." << endl;
+    cerr << "       boggletools minhash <corpus> <similarity index>" << endl;
+    cerr << "       boggletools similar <similarity index> <board id or letters> [count]" << endl;
+    cerr << "       boggletools rate <corpus> [rule set]" << endl;
+    cerr << "       boggletools anagram <letters> [min length]" << endl;
+    cerr << "       boggletools replay <game log>" << endl;
+    cerr << "       boggletools bench <corpus> [prefetch distance ...]" << endl;
+    cerr << "       boggletools succinct <corpus>" << endl;
+    cerr << "       boggletools corpuscheck <corpus>" << endl;
+    cerr << "       boggletools maptrie <trie file>" << endl;
+    cerr << "       boggletools outofcore <trie file> <corpus> [bloom depth ...]" << endl;
+    cerr << "       boggletools tiers <corpus> [frequency file]" << endl;
+    cerr << "       boggletools maxboard <rows>x<cols> <target> <checkpoint> [workers]" << endl;
+    cerr << "       boggletools worstcase <size> <climbs> <nodes|dictionary|louds|trie file> [corpus]" << endl;
+    return 2;
+}